@@ -0,0 +1,237 @@
+#include "BounceLyricsWriter.h"
+#include <cmath>
+
+namespace
+{
+    juce::String formatLrcTime (double seconds)
+    {
+        const auto centiseconds = static_cast<juce::int64> (std::floor (seconds * 100.0));
+        return juce::String (centiseconds / 6000).paddedLeft ('0', 2) + ":"
+             + juce::String ((centiseconds / 100) % 60).paddedLeft ('0', 2) + "."
+             + juce::String (centiseconds % 100).paddedLeft ('0', 2);
+    }
+
+    juce::String formatSrtTime (double seconds)
+    {
+        const auto milliseconds = static_cast<juce::int64> (std::round (seconds * 1000.0));
+        return juce::String (milliseconds / 3600000).paddedLeft ('0', 2) + ":"
+             + juce::String ((milliseconds / 60000) % 60).paddedLeft ('0', 2) + ":"
+             + juce::String ((milliseconds / 1000) % 60).paddedLeft ('0', 2) + ","
+             + juce::String (milliseconds % 1000).paddedLeft ('0', 3);
+    }
+
+    void addTransition (std::vector<BounceLyricsWriter::Transition>& transitions, juce::int64 sample, int line)
+    {
+        if (! transitions.empty() && transitions.back().sample >= sample)
+            transitions.back().line = line;
+        else
+            transitions.push_back ({ sample, line });
+    }
+}
+
+BounceLyricsWriter::BounceLyricsWriter()
+    : juce::Thread ("Bounce Lyrics Writer"),
+      blocks ((size_t) capacity)
+{
+}
+
+BounceLyricsWriter::~BounceLyricsWriter()
+{
+    end();
+    waitForThreadToExit (-1);
+}
+
+bool BounceLyricsWriter::prepare (Session newSession)
+{
+    end();
+
+    // Writing the previous files normally takes milliseconds; don't stall the
+    // caller if it takes longer.
+    if (! waitForThreadToExit (2000))
+        return false;
+
+    session = std::move (newSession);
+    transitions.clear();
+    endSample = 0;
+    currentLine = -1;
+
+    // Drop any block pushed as the last session ended. This is the reading
+    // side, so it stays safe against an audio thread still inside pushBlock.
+    fifo.finishedRead (fifo.getNumReady());
+
+    finishRequested.store (false);
+    startThread();
+    prepared.store (true);
+    return true;
+}
+
+bool BounceLyricsWriter::begin (double sampleRate)
+{
+    if (! prepared.exchange (false))
+        return false;
+
+    // The writer thread reads the session only for blocks pushed after this.
+    session.sampleRate = sampleRate;
+    active.store (true);
+    return true;
+}
+
+void BounceLyricsWriter::end()
+{
+    const bool wasPrepared = prepared.exchange (false);
+    const bool wasActive = active.exchange (false);
+
+    if (! wasPrepared && ! wasActive)
+        return;
+
+    finishRequested.store (true);
+    notify();
+}
+
+bool BounceLyricsWriter::isActive() const
+{
+    return active.load();
+}
+
+bool BounceLyricsWriter::hasSession() const
+{
+    return prepared.load() || active.load();
+}
+
+void BounceLyricsWriter::pushBlock (const Block& block)
+{
+    if (! active.load())
+        return;
+
+    while (fifo.getFreeSpace() == 0 && active.load())
+        juce::Thread::yield();
+
+    const auto scope = fifo.write (1);
+    if (scope.blockSize1 > 0)
+        blocks[(size_t) scope.startIndex1] = block;
+
+    notify();
+}
+
+void BounceLyricsWriter::run()
+{
+    for (;;)
+    {
+        // Read the flag first so blocks pushed before end() are all drained.
+        const bool finishing = finishRequested.load();
+
+        for (;;)
+        {
+            const auto scope = fifo.read (1);
+            if (scope.blockSize1 <= 0)
+                break;
+
+            addBlock (blocks[(size_t) scope.startIndex1]);
+        }
+
+        if (finishing)
+            break;
+
+        wait (20);
+    }
+
+    writeFiles();
+}
+
+void BounceLyricsWriter::addBlock (const Block& block)
+{
+    endSample = block.samplePosition + block.numSamples;
+    findTransitions (session.timeline, session.sampleRate, block, currentLine, transitions);
+}
+
+void BounceLyricsWriter::findTransitions (const PrompterTimeline& timeline, double sampleRate, const Block& block,
+                                          int& currentLine, std::vector<Transition>& transitions)
+{
+    if (! block.isValid)
+        return;
+
+    const auto lineAt = [&timeline] (double bar) { return timeline.getPositionAtBar (bar).line; };
+
+    const double numerator = static_cast<double> (juce::jmax (1, block.numerator));
+    const double barStart = block.ppq / numerator;
+    const double barsPerSample = block.isPlaying ? block.bpm / (60.0 * numerator) / sampleRate : 0.0;
+    const double barEnd = barStart + barsPerSample * block.numSamples;
+
+    int line = lineAt (barStart);
+    if (line != currentLine)
+        addTransition (transitions, block.samplePosition, line);
+
+    // Within the block the bar position moves linearly, so each line change can
+    // be bisected and then pinned to the first sample that shows the new line.
+    double lo = barStart;
+
+    while (barsPerSample > 0.0 && lineAt (barEnd) != line)
+    {
+        double hi = barEnd;
+        for (int i = 0; i < 48; ++i)
+        {
+            const double mid = 0.5 * (lo + hi);
+
+            if (lineAt (mid) == line)
+                lo = mid;
+            else
+                hi = mid;
+        }
+
+        // Step from the sample below the crossing rather than rounding hi up,
+        // which lands one sample late when the crossing falls exactly on one.
+        auto offset = static_cast<juce::int64> (std::floor ((lo - barStart) / barsPerSample));
+        while (offset < block.numSamples - 1 && lineAt (barStart + barsPerSample * static_cast<double> (offset)) == line)
+            ++offset;
+
+        line = lineAt (hi);
+        addTransition (transitions, block.samplePosition + offset, line);
+        lo = hi;
+    }
+
+    currentLine = line;
+}
+
+void BounceLyricsWriter::writeFiles() const
+{
+    if (transitions.empty() || ! session.outputFolder.createDirectory())
+        return;
+
+    // Never overwrite an earlier bounce; the .srt shares the .lrc's name.
+    const auto lrcFile = session.outputFolder.getChildFile (session.baseName + ".lrc").getNonexistentSibling();
+    lrcFile.replaceWithText (createLrc (session.lines, transitions, session.sampleRate));
+    lrcFile.withFileExtension (".srt").replaceWithText (createSrt (session.lines, transitions, endSample, session.sampleRate));
+}
+
+juce::String BounceLyricsWriter::createLrc (const juce::StringArray& lines, const std::vector<Transition>& transitions,
+                                            double sampleRate)
+{
+    juce::String lrc;
+
+    for (auto& transition : transitions)
+        lrc << "[" << formatLrcTime (transition.sample / sampleRate) << "]" << lines[transition.line].trim() << "\n";
+
+    return lrc;
+}
+
+juce::String BounceLyricsWriter::createSrt (const juce::StringArray& lines, const std::vector<Transition>& transitions,
+                                            juce::int64 endSample, double sampleRate)
+{
+    juce::String srt;
+    int index = 0;
+
+    for (size_t i = 0; i < transitions.size(); ++i)
+    {
+        const auto text = lines[transitions[i].line].trim();
+        if (text.isEmpty())
+            continue;
+
+        const auto lineEnd = i + 1 < transitions.size() ? transitions[i + 1].sample : endSample;
+
+        srt << ++index << "\n"
+            << formatSrtTime (transitions[i].sample / sampleRate) << " --> " << formatSrtTime (lineEnd / sampleRate) << "\n"
+            << text << "\n\n";
+    }
+
+    return srt;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "PrompterTimeline.h"
+#include <atomic>
+#include <vector>
+
+class BounceLyricsWriter : private juce::Thread
+{
+public:
+    struct Block
+    {
+        juce::int64 samplePosition = 0;
+        double ppq = 0.0;
+        double bpm = 120.0;
+        int numerator = 4;
+        int numSamples = 0;
+        bool isPlaying = false;
+        bool isValid = false;
+    };
+
+    struct Session
+    {
+        juce::StringArray lines;
+        PrompterTimeline timeline;
+        double sampleRate = 44100.0;
+        juce::File outputFolder;
+        juce::String baseName;
+    };
+
+    struct Transition
+    {
+        juce::int64 sample = 0;
+        int line = 0;
+    };
+
+    BounceLyricsWriter();
+    ~BounceLyricsWriter() override;
+
+    // Message thread: takes the session and starts the writer thread, which
+    // idles until begin() switches logging on. Returns false, dropping the
+    // session, if the previous bounce is still being written after a short wait.
+    bool prepare (Session newSession);
+
+    // Audio thread: starts logging into the prepared session without locking
+    // or allocating. Returns false when no session is prepared.
+    bool begin (double sampleRate);
+    void end();
+    bool isActive() const;
+    bool hasSession() const;
+
+    // Audio thread during an offline render. Waits for space rather than
+    // dropping blocks, since nothing is listening in real time.
+    void pushBlock (const Block& block);
+
+    // Appends the line changes within one block, each placed on the first sample
+    // that shows the new line. currentLine carries the line between blocks and
+    // starts at -1.
+    static void findTransitions (const PrompterTimeline& timeline, double sampleRate, const Block& block,
+                                 int& currentLine, std::vector<Transition>& transitions);
+
+    static juce::String createLrc (const juce::StringArray& lines, const std::vector<Transition>& transitions,
+                                   double sampleRate);
+    static juce::String createSrt (const juce::StringArray& lines, const std::vector<Transition>& transitions,
+                                   juce::int64 endSample, double sampleRate);
+
+private:
+    void run() override;
+    void addBlock (const Block& block);
+    void writeFiles() const;
+
+    static constexpr int capacity = 4096;
+
+    juce::AbstractFifo fifo { capacity };
+    std::vector<Block> blocks;
+    std::atomic<bool> prepared { false };
+    std::atomic<bool> active { false };
+    std::atomic<bool> finishRequested { false };
+
+    Session session;
+    std::vector<Transition> transitions;
+    juce::int64 endSample = 0;
+    int currentLine = -1;
+
+    JUCE_DECLARE_NON_COPYABLE (BounceLyricsWriter)
+};
@@ -0,0 +1,195 @@
+#include "InputMeter.h"
+#include <juce_dsp/juce_dsp.h>
+#include <cmath>
+
+namespace
+{
+    // ITU-R BS.1770 K-weighting: a high-shelf pre-filter followed by the RLB
+    // high-pass, recomputed for the host sample rate.
+    juce::IIRCoefficients makeShelfCoefficients (double sampleRate)
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+
+        const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double vh = std::pow (10.0, gainDb / 20.0);
+        const double vb = std::pow (vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        return juce::IIRCoefficients ((vh + vb * k / q + k * k) / a0,
+                                      2.0 * (k * k - vh) / a0,
+                                      (vh - vb * k / q + k * k) / a0,
+                                      1.0,
+                                      2.0 * (k * k - 1.0) / a0,
+                                      (1.0 - k / q + k * k) / a0);
+    }
+
+    juce::IIRCoefficients makeHighPassCoefficients (double sampleRate)
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+
+        const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        return juce::IIRCoefficients (1.0, -2.0, 1.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0);
+    }
+
+    float toDecibels (double power)
+    {
+        return power > 1.0e-10 ? static_cast<float> (10.0 * std::log10 (power)) : -100.0f;
+    }
+}
+
+void InputMeter::prepare (double sampleRate, int maximumBlockSize, int numChannels)
+{
+    currentSampleRate = sampleRate > 0.0 ? sampleRate : 44100.0;
+    samplesPerLoudnessBlock = juce::jmax (1, juce::roundToInt (currentSampleRate * 0.1));
+
+    scratch.setSize (1, juce::jmax (1, maximumBlockSize));
+    kWeighting.resize (static_cast<size_t> (juce::jmax (0, numChannels)));
+
+    const auto shelf = makeShelfCoefficients (currentSampleRate);
+    const auto highPass = makeHighPassCoefficients (currentSampleRate);
+
+    for (auto& filters : kWeighting)
+    {
+        filters[0].setCoefficients (shelf);
+        filters[1].setCoefficients (highPass);
+    }
+
+    // Peak falls back 20 dB per second; RMS integrates over roughly 300 ms.
+    peakDecayPerSample = static_cast<float> (std::pow (10.0, -1.0 / currentSampleRate));
+    rmsCoefficientPerSample = static_cast<float> (1.0 - std::exp (-1.0 / (0.3 * currentSampleRate)));
+
+    reset();
+}
+
+void InputMeter::reset()
+{
+    for (auto& filters : kWeighting)
+        for (auto& filter : filters)
+            filter.reset();
+
+    blockEnergies.fill (0.0);
+    blockEnergySum = 0.0;
+    pendingEnergy = 0.0;
+    pendingSamples = 0;
+    nextBlock = 0;
+    peakHold = 0.0f;
+    meanSquare = 0.0f;
+
+    peakDb.store (-100.0f);
+    rmsDb.store (-100.0f);
+    shortTermLufs.store (-100.0f);
+}
+
+void InputMeter::process (const juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    numChannels = juce::jmin (numChannels, buffer.getNumChannels(), static_cast<int> (kWeighting.size()));
+    if (numChannels <= 0)
+        return;
+
+    const int chunkSize = scratch.getNumSamples();
+    for (int start = 0; start < buffer.getNumSamples(); start += chunkSize)
+        processChunk (buffer, numChannels, start, juce::jmin (chunkSize, buffer.getNumSamples() - start));
+
+    peakDb.store (juce::Decibels::gainToDecibels (peakHold, -100.0f));
+    rmsDb.store (toDecibels (meanSquare));
+}
+
+void InputMeter::processChunk (const juce::AudioBuffer<float>& buffer, int numChannels, int startSample, int numSamples)
+{
+    float blockPeak = 0.0f;
+    double squares = 0.0;
+    double weightedSquares = 0.0;
+    auto* weighted = scratch.getWritePointer (0);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* input = buffer.getReadPointer (channel, startSample);
+        const auto range = juce::FloatVectorOperations::findMinAndMax (input, numSamples);
+
+        blockPeak = juce::jmax (blockPeak, -range.getStart(), range.getEnd());
+        squares += getSumOfSquares (input, numSamples);
+
+        juce::FloatVectorOperations::copy (weighted, input, numSamples);
+        for (auto& filter : kWeighting[(size_t) channel])
+            filter.processSamples (weighted, numSamples);
+
+        weightedSquares += getSumOfSquares (weighted, numSamples);
+    }
+
+    peakHold = juce::jmax (blockPeak, peakHold * std::pow (peakDecayPerSample, static_cast<float> (numSamples)));
+
+    const auto blockMeanSquare = static_cast<float> (squares / (numSamples * numChannels));
+    const auto smoothing = 1.0f - std::pow (1.0f - rmsCoefficientPerSample, static_cast<float> (numSamples));
+    meanSquare += (blockMeanSquare - meanSquare) * smoothing;
+
+    addLoudnessEnergy (weightedSquares, numSamples);
+}
+
+void InputMeter::addLoudnessEnergy (double energy, int numSamples)
+{
+    // Short-term loudness is the mean K-weighted power over the last 3 s,
+    // kept as a ring of 100 ms block sums so each update is O(1). A chunk that
+    // crosses block boundaries is split, its energy shared out by sample count.
+    pendingEnergy += energy;
+    pendingSamples += numSamples;
+
+    if (pendingSamples < samplesPerLoudnessBlock)
+        return;
+
+    while (pendingSamples >= samplesPerLoudnessBlock)
+    {
+        const int leftoverSamples = pendingSamples - samplesPerLoudnessBlock;
+        const double leftoverEnergy = pendingEnergy * leftoverSamples / pendingSamples;
+        const double completedEnergy = pendingEnergy - leftoverEnergy;
+
+        blockEnergySum += completedEnergy - blockEnergies[(size_t) nextBlock];
+        blockEnergies[(size_t) nextBlock] = completedEnergy;
+        nextBlock = (nextBlock + 1) % loudnessBlocks;
+
+        pendingEnergy = leftoverEnergy;
+        pendingSamples = leftoverSamples;
+    }
+
+    const double windowSamples = static_cast<double> (samplesPerLoudnessBlock) * loudnessBlocks;
+    const double meanPower = juce::jmax (0.0, blockEnergySum) / windowSamples;
+
+    shortTermLufs.store (meanPower > 1.0e-10 ? static_cast<float> (-0.691 + 10.0 * std::log10 (meanPower)) : -100.0f);
+}
+
+InputMeter::Snapshot InputMeter::getSnapshot() const
+{
+    return { peakDb.load(), rmsDb.load(), shortTermLufs.load() };
+}
+
+float InputMeter::getSumOfSquares (const float* data, int numSamples)
+{
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    const auto* aligned = Register::getNextSIMDAlignedPtr (const_cast<float*> (data));
+    const int head = juce::jmin (numSamples, static_cast<int> (aligned - data));
+
+    float sum = 0.0f;
+    for (int i = 0; i < head; ++i)
+        sum += data[i] * data[i];
+
+    const int numVectors = (numSamples - head) / static_cast<int> (Register::SIMDNumElements);
+    auto accumulator = Register::expand (0.0f);
+
+    for (int i = 0; i < numVectors; ++i)
+    {
+        const auto value = Register::fromRawArray (aligned + i * static_cast<int> (Register::SIMDNumElements));
+        accumulator += value * value;
+    }
+
+    sum += accumulator.sum();
+
+    for (int i = head + numVectors * static_cast<int> (Register::SIMDNumElements); i < numSamples; ++i)
+        sum += data[i] * data[i];
+
+    return sum;
+}
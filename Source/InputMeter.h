@@ -0,0 +1,53 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+class InputMeter
+{
+public:
+    struct Snapshot
+    {
+        float peakDb = -100.0f;
+        float rmsDb = -100.0f;
+        float shortTermLufs = -100.0f;
+    };
+
+    void prepare (double sampleRate, int maximumBlockSize, int numChannels);
+    void reset();
+
+    void process (const juce::AudioBuffer<float>& buffer, int numChannels);
+
+    Snapshot getSnapshot() const;
+
+    static float getSumOfSquares (const float* data, int numSamples);
+
+private:
+    void processChunk (const juce::AudioBuffer<float>& buffer, int numChannels, int startSample, int numSamples);
+    void addLoudnessEnergy (double energy, int numSamples);
+
+    static constexpr int loudnessBlocks = 30;
+
+    double currentSampleRate = 44100.0;
+    int samplesPerLoudnessBlock = 4410;
+
+    juce::AudioBuffer<float> scratch;
+    std::vector<std::array<juce::IIRFilter, 2>> kWeighting;
+
+    std::array<double, loudnessBlocks> blockEnergies {};
+    double blockEnergySum = 0.0;
+    double pendingEnergy = 0.0;
+    int pendingSamples = 0;
+    int nextBlock = 0;
+
+    float peakHold = 0.0f;
+    float meanSquare = 0.0f;
+    float peakDecayPerSample = 1.0f;
+    float rmsCoefficientPerSample = 0.0f;
+
+    std::atomic<float> peakDb { -100.0f };
+    std::atomic<float> rmsDb { -100.0f };
+    std::atomic<float> shortTermLufs { -100.0f };
+};
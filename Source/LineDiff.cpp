@@ -0,0 +1,45 @@
+#include "LineDiff.h"
+
+bool LineDiff::isEmpty() const
+{
+    return numRemovedLines == 0 && insertedLines.isEmpty();
+}
+
+int LineDiff::mapLine (int oldLine) const
+{
+    if (oldLine < firstLine)
+        return oldLine;
+
+    const int offset = oldLine - firstLine;
+    if (offset < numRemovedLines)
+        return offset < insertedLines.size() ? oldLine : -1;
+
+    return oldLine + insertedLines.size() - numRemovedLines;
+}
+
+LineDiff LineDiff::compute (const juce::StringArray& oldLines, const juce::StringArray& newLines)
+{
+    // Trimming the common head and tail gives a single changed range. That is the
+    // exact diff for the usual case of one edited region, and still a correct
+    // (if larger) edit when several regions changed.
+    const int numOld = oldLines.size();
+    const int numNew = newLines.size();
+
+    int prefix = 0;
+    while (prefix < numOld && prefix < numNew && oldLines[prefix] == newLines[prefix])
+        ++prefix;
+
+    int suffix = 0;
+    while (suffix < numOld - prefix && suffix < numNew - prefix
+           && oldLines[numOld - 1 - suffix] == newLines[numNew - 1 - suffix])
+        ++suffix;
+
+    LineDiff diff;
+    diff.firstLine = prefix;
+    diff.numRemovedLines = numOld - prefix - suffix;
+
+    for (int i = prefix; i < numNew - suffix; ++i)
+        diff.insertedLines.add (newLines[i]);
+
+    return diff;
+}
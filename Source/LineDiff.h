@@ -0,0 +1,18 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+struct LineDiff
+{
+    int firstLine = 0;
+    int numRemovedLines = 0;
+    juce::StringArray insertedLines;
+
+    bool isEmpty() const;
+
+    // Where a line of the old text ends up in the new one, or -1 if it was
+    // removed. Lines replaced in place keep their index.
+    int mapLine (int oldLine) const;
+
+    static LineDiff compute (const juce::StringArray& oldLines, const juce::StringArray& newLines);
+};
@@ -0,0 +1,140 @@
+#include "LineLayoutCache.h"
+#include <cmath>
+
+void LineLayoutCache::setFont (const juce::Font& newFont)
+{
+    font = newFont;
+
+    for (auto& table : tables)
+        table.valid = false;
+}
+
+void LineLayoutCache::setLines (const juce::StringArray& newLines)
+{
+    lines = newLines;
+    tables.assign (static_cast<size_t> (lines.size()), {});
+}
+
+void LineLayoutCache::replaceLines (int firstLine, int numRemovedLines, const juce::StringArray& insertedLines)
+{
+    firstLine = juce::jlimit (0, lines.size(), firstLine);
+    numRemovedLines = juce::jlimit (0, lines.size() - firstLine, numRemovedLines);
+
+    juce::StringArray updated;
+    updated.ensureStorageAllocated (lines.size() - numRemovedLines + insertedLines.size());
+
+    for (int i = 0; i < firstLine; ++i)
+        updated.add (lines[i]);
+
+    updated.addArray (insertedLines);
+
+    for (int i = firstLine + numRemovedLines; i < lines.size(); ++i)
+        updated.add (lines[i]);
+
+    lines.swapWith (updated);
+
+    const auto first = tables.begin() + firstLine;
+    tables.erase (first, first + numRemovedLines);
+    tables.insert (tables.begin() + firstLine, static_cast<size_t> (insertedLines.size()), {});
+}
+
+int LineLayoutCache::getNumLines() const
+{
+    return lines.size();
+}
+
+const juce::StringArray& LineLayoutCache::getLines() const
+{
+    return lines;
+}
+
+void LineLayoutCache::prepareLine (int lineIndex)
+{
+    if (! juce::isPositiveAndBelow (lineIndex, lines.size()))
+        return;
+
+    auto& table = tables[(size_t) lineIndex];
+    if (! table.valid)
+        buildTable (font, lines[lineIndex], table);
+}
+
+void LineLayoutCache::prepareAll()
+{
+    for (int i = 0; i < lines.size(); ++i)
+        prepareLine (i);
+}
+
+int LineLayoutCache::getNumSegments (int lineIndex) const
+{
+    if (! juce::isPositiveAndBelow (lineIndex, lines.size()))
+        return 0;
+
+    return static_cast<int> (tables[(size_t) lineIndex].segmentEnds.size());
+}
+
+int LineLayoutCache::getSegmentIndex (int lineIndex, double progress) const
+{
+    const int numSegments = getNumSegments (lineIndex);
+    if (numSegments == 0)
+        return -1;
+
+    return juce::jlimit (0, numSegments - 1, static_cast<int> (std::floor (progress * numSegments)));
+}
+
+float LineLayoutCache::getProgressWidth (int lineIndex, double progress) const
+{
+    const int segment = getSegmentIndex (lineIndex, progress);
+    if (segment < 0)
+        return 0.0f;
+
+    return tables[(size_t) lineIndex].segmentEnds[(size_t) segment];
+}
+
+void LineLayoutCache::buildTable (const juce::Font& font, const juce::String& line, LineTable& table)
+{
+    table.segmentEnds.clear();
+    table.valid = true;
+
+    juce::Array<int> glyphs;
+    juce::Array<float> offsets;
+    font.getGlyphPositions (line, glyphs, offsets);
+
+    const int numChars = line.length();
+    auto getOffset = [&] (int charIndex)
+    {
+        if (offsets.size() == numChars + 1)
+            return offsets.getUnchecked (charIndex);
+
+        return font.getStringWidthFloat (line.substring (0, charIndex));
+    };
+
+    // Segments are whitespace-separated words, further split after hyphens so
+    // lyric sheets written as "beau-ti-ful" highlight syllable by syllable.
+    auto text = line.getCharPointer();
+    bool inSegment = false;
+
+    for (int i = 0; i < numChars; ++i)
+    {
+        const auto c = text.getAndAdvance();
+
+        if (juce::CharacterFunctions::isWhitespace (c))
+        {
+            if (inSegment)
+                table.segmentEnds.push_back (getOffset (i));
+
+            inSegment = false;
+        }
+        else if (c == '-' && inSegment)
+        {
+            table.segmentEnds.push_back (getOffset (i + 1));
+            inSegment = false;
+        }
+        else
+        {
+            inSegment = true;
+        }
+    }
+
+    if (inSegment)
+        table.segmentEnds.push_back (getOffset (numChars));
+}
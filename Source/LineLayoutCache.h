@@ -0,0 +1,35 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <vector>
+
+class LineLayoutCache
+{
+public:
+    void setFont (const juce::Font& newFont);
+    void setLines (const juce::StringArray& newLines);
+    void replaceLines (int firstLine, int numRemovedLines, const juce::StringArray& insertedLines);
+
+    int getNumLines() const;
+    const juce::StringArray& getLines() const;
+
+    void prepareLine (int lineIndex);
+    void prepareAll();
+
+    int getNumSegments (int lineIndex) const;
+    int getSegmentIndex (int lineIndex, double progress) const;
+    float getProgressWidth (int lineIndex, double progress) const;
+
+private:
+    struct LineTable
+    {
+        std::vector<float> segmentEnds;
+        bool valid = false;
+    };
+
+    static void buildTable (const juce::Font& font, const juce::String& line, LineTable& table);
+
+    juce::Font font { 24.0f };
+    juce::StringArray lines;
+    std::vector<LineTable> tables;
+};
@@ -0,0 +1,165 @@
+#include "OscRemote.h"
+
+namespace
+{
+    float getFloatArgument (const juce::OSCMessage& message, int index = 0)
+    {
+        if (message.size() <= index)
+            return 0.0f;
+
+        const auto& argument = message[index];
+        if (argument.isFloat32())
+            return argument.getFloat32();
+
+        if (argument.isInt32())
+            return static_cast<float> (argument.getInt32());
+
+        return 0.0f;
+    }
+}
+
+OscRemote::OscRemote()
+{
+    receiver.addListener (this);
+}
+
+OscRemote::~OscRemote()
+{
+    stop();
+    receiver.removeListener (this);
+}
+
+bool OscRemote::start (const Settings& newSettings)
+{
+    stop();
+    settings = newSettings;
+
+    // With a packet sink installed (a loopback stand-in), messages are injected
+    // through handleMessage() and no sockets are opened.
+    if (! packetSink)
+    {
+        if (! receiver.connect (settings.listenPort))
+            return false;
+
+        if (! sender.connect (settings.targetHost, settings.targetPort))
+        {
+            receiver.disconnect();
+            return false;
+        }
+    }
+
+    running = true;
+
+    if (settings.broadcastRateHz > 0)
+        startTimer (juce::jmax (1, 1000 / settings.broadcastRateHz));
+
+    return true;
+}
+
+void OscRemote::stop()
+{
+    stopTimer();
+
+    if (running)
+    {
+        receiver.disconnect();
+        sender.disconnect();
+        running = false;
+    }
+}
+
+bool OscRemote::isRunning() const
+{
+    return running;
+}
+
+const OscRemote::Settings& OscRemote::getSettings() const
+{
+    return settings;
+}
+
+void OscRemote::setPacketSink (PacketSink newSink)
+{
+    jassert (! running);
+    packetSink = std::move (newSink);
+}
+
+void OscRemote::handleMessage (const juce::OSCMessage& message)
+{
+    const auto address = message.getAddressPattern().toString();
+
+    if (address == "/rosetta/next")
+        pushCommand ({ Command::Type::nextLine });
+    else if (address == "/rosetta/previous")
+        pushCommand ({ Command::Type::previousLine });
+    else if (address == "/rosetta/jump")
+        pushCommand ({ Command::Type::jumpToLine, juce::roundToInt (getFloatArgument (message)) - 1 });
+    else if (address == "/rosetta/start")
+        pushCommand ({ Command::Type::setStartBar, 0, getFloatArgument (message) });
+    else if (address == "/rosetta/end")
+        pushCommand ({ Command::Type::setEndBar, 0, getFloatArgument (message) });
+    else if (address == "/rosetta/weight")
+        pushCommand ({ Command::Type::setLineWeight, juce::roundToInt (getFloatArgument (message)) - 1, getFloatArgument (message, 1) });
+    else if (address == "/rosetta/load" && ! message.isEmpty() && message[0].isString())
+        pushCommand ({ Command::Type::loadScript, 0, 0.0f, message[0].getString() });
+}
+
+bool OscRemote::popCommand (Command& command)
+{
+    const auto scope = commandFifo.read (1);
+    if (scope.blockSize1 <= 0)
+        return false;
+
+    command = std::move (commands[(size_t) scope.startIndex1]);
+    return true;
+}
+
+void OscRemote::publishActiveLine (int lineIndex, int numLines)
+{
+    activeLine.store (lineIndex);
+    lineCount.store (numLines);
+}
+
+void OscRemote::publishTransport (double barPosition, bool isPlaying)
+{
+    transportBar.store (barPosition);
+    transportPlaying.store (isPlaying);
+}
+
+void OscRemote::oscMessageReceived (const juce::OSCMessage& message)
+{
+    handleMessage (message);
+}
+
+void OscRemote::oscBundleReceived (const juce::OSCBundle& bundle)
+{
+    for (auto& element : bundle)
+    {
+        if (element.isMessage())
+            handleMessage (element.getMessage());
+        else if (element.isBundle())
+            oscBundleReceived (element.getBundle());
+    }
+}
+
+void OscRemote::hiResTimerCallback()
+{
+    // Everything that changed since the last tick goes out as one bundle, so the
+    // packet rate stays at the broadcast rate however often the state changes.
+    juce::OSCBundle bundle;
+    bundle.addElement (juce::OSCMessage ("/rosetta/line", activeLine.load() + 1, lineCount.load()));
+    bundle.addElement (juce::OSCMessage ("/rosetta/transport", static_cast<float> (transportBar.load()),
+                                         transportPlaying.load() ? 1 : 0));
+
+    if (packetSink)
+        packetSink (bundle);
+    else
+        sender.send (bundle);
+}
+
+void OscRemote::pushCommand (Command command)
+{
+    const auto scope = commandFifo.write (1);
+    if (scope.blockSize1 > 0)
+        commands[(size_t) scope.startIndex1] = std::move (command);
+}
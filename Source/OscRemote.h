@@ -0,0 +1,87 @@
+#pragma once
+
+#include <juce_osc/juce_osc.h>
+#include <array>
+#include <atomic>
+#include <functional>
+
+class OscRemote : private juce::OSCReceiver::Listener<juce::OSCReceiver::RealtimeCallback>,
+                  private juce::HighResolutionTimer
+{
+public:
+    struct Command
+    {
+        enum class Type
+        {
+            nextLine,
+            previousLine,
+            jumpToLine,
+            setStartBar,
+            setEndBar,
+            setLineWeight,
+            loadScript
+        };
+
+        Type type = Type::nextLine;
+        int line = 0;
+        float value = 0.0f;
+        juce::String path;
+    };
+
+    struct Settings
+    {
+        int listenPort = 9000;
+        juce::String targetHost { "127.0.0.1" };
+        int targetPort = 9001;
+        int broadcastRateHz = 30;
+
+        bool operator== (const Settings& other) const
+        {
+            return listenPort == other.listenPort && targetHost == other.targetHost
+                && targetPort == other.targetPort && broadcastRateHz == other.broadcastRateHz;
+        }
+
+        bool operator!= (const Settings& other) const { return ! operator== (other); }
+    };
+
+    using PacketSink = std::function<bool (const juce::OSCBundle&)>;
+
+    OscRemote();
+    ~OscRemote() override;
+
+    bool start (const Settings& newSettings);
+    void stop();
+    bool isRunning() const;
+    const Settings& getSettings() const;
+
+    void setPacketSink (PacketSink newSink);
+
+    void handleMessage (const juce::OSCMessage& message);
+    bool popCommand (Command& command);
+
+    void publishActiveLine (int lineIndex, int numLines);
+    void publishTransport (double barPosition, bool isPlaying);
+
+private:
+    void oscMessageReceived (const juce::OSCMessage& message) override;
+    void oscBundleReceived (const juce::OSCBundle& bundle) override;
+    void hiResTimerCallback() override;
+    void pushCommand (Command command);
+
+    juce::OSCReceiver receiver;
+    juce::OSCSender sender;
+    PacketSink packetSink;
+    Settings settings;
+    bool running = false;
+
+    static constexpr int commandCapacity = 256;
+    juce::AbstractFifo commandFifo { commandCapacity };
+    std::array<Command, commandCapacity> commands;
+
+    std::atomic<int> activeLine { 0 };
+    std::atomic<int> lineCount { 1 };
+    std::atomic<double> transportBar { 0.0 };
+    std::atomic<bool> transportPlaying { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OscRemote)
+};
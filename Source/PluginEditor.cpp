@@ -1,5 +1,4 @@
 #include "PluginEditor.h"
-#include <cmath>
 
 RosettaPrompterAudioProcessorEditor::RosettaPrompterAudioProcessorEditor (RosettaPrompterAudioProcessor& p)
     : AudioProcessorEditor (&p),
@@ -41,27 +40,64 @@ RosettaPrompterAudioProcessorEditor::RosettaPrompterAudioProcessorEditor (Rosett
         repaint();
     };
 
+    for (int i = 1; i <= TeleprompterComponent::maxColumns; ++i)
+        columnsBox.addItem (juce::String (i) + (i == 1 ? " Column" : " Columns"), i);
+    columnsBox.setSelectedId (processor.getNumLyricsColumns(), juce::dontSendNotification);
+    columnsBox.onChange = [this]
+    {
+        setNumColumns (columnsBox.getSelectedId());
+    };
+
+    importColumnBox.addItem ("Into Original", 1);
+    importColumnBox.addItem ("Into Translation", 2);
+    importColumnBox.addItem ("Into Phonetic", 3);
+    importColumnBox.setSelectedId (1, juce::dontSendNotification);
+
     importButton.onClick = [this]
     {
-        juce::FileChooser chooser ("Import lyrics", juce::File(), "*.txt");
-        chooser.launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        fileChooser = std::make_unique<juce::FileChooser> ("Import lyrics", juce::File(), "*.txt");
+        fileChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
             [this] (const juce::FileChooser& fc)
             {
-                const auto file = fc.getResult();
-                if (file.existsAsFile())
-                {
-                    const auto text = file.loadFileAsString();
-                    teleprompter.setText (text);
-                    processor.setLyricsText (text);
-                }
+                importLyricsFile (fc.getResult(), importColumnBox.getSelectedId() - 1);
             });
     };
 
     openCacheButton.onClick = []
     {
-        RosettaPrompterAudioProcessor::getCacheFolder().revealToUser();
+        RosettaPrompterAudioProcessor::createCacheFolder().revealToUser();
+    };
+
+    oscButton.setClickingTogglesState (true);
+    oscButton.setToggleState (processor.isOscEnabled(), juce::dontSendNotification);
+    oscButton.onClick = [this]
+    {
+        if (! processor.setOscEnabled (oscButton.getToggleState()))
+        {
+            const auto& settings = processor.getOscRemote().getSettings();
+            juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::WarningIcon, "OSC Remote",
+                "Could not listen on UDP port " + juce::String (settings.listenPort) + " or send to "
+                    + settings.targetHost + ":" + juce::String (settings.targetPort) + ".");
+        }
+
+        oscButton.setToggleState (processor.isOscEnabled(), juce::dontSendNotification);
     };
 
+    for (int i = 0; i < TeleprompterComponent::maxColumns; ++i)
+    {
+        auto& watcher = scriptWatchers[(size_t) i];
+
+        watcher.getDocument = [this, i]() -> ScriptFileWatcher::Document
+        {
+            return { teleprompter.getColumnText (i), teleprompter.getColumnRevision (i) };
+        };
+
+        watcher.onFileChanged = [this, i] (const LineDiff& diff, int revision)
+        {
+            return teleprompter.applyLineDiff (i, diff, revision);
+        };
+    }
+
     setStartButton.onClick = [this]
     {
         processor.setStartBarToCurrent();
@@ -72,14 +108,57 @@ RosettaPrompterAudioProcessorEditor::RosettaPrompterAudioProcessorEditor (Rosett
         processor.setEndBarToCurrent();
     };
 
-    teleprompter.onTextChanged = [this] (const juce::String& text)
+    teleprompter.onTextChanged = [this] (int column, const juce::String& text)
+    {
+        processor.setLyricsText (text, column);
+
+        if (column == 0)
+            timeline.setLines (juce::StringArray::fromLines (text));
+    };
+
+    timingModeBox.addItemList (juce::StringArray { "Linear Timing", "Syllable Timing", "Tapped Timing" }, 1);
+
+    recordTimingButton.setClickingTogglesState (true);
+    recordTimingButton.onClick = [this]
+    {
+        processor.setTimingRecording (recordTimingButton.getToggleState());
+        recordTimingButton.setToggleState (processor.isTimingRecording(), juce::dontSendNotification);
+
+        if (processor.isTimingRecording())
+            grabKeyboardFocus();
+    };
+
+    // Taps fire on mouse-down; waiting for the release would add the click's length.
+    tapButton.setTriggeredOnMouseDown (true);
+    tapButton.setWantsKeyboardFocus (false);
+    tapButton.onClick = [this]
+    {
+        tapTiming();
+    };
+
+    clearTimingButton.onClick = [this]
     {
-        processor.setLyricsText (text);
+        processor.clearTimingMap();
     };
 
+    traceButton.setClickingTogglesState (true);
+    traceButton.setToggleState (processor.isTraceRecording(), juce::dontSendNotification);
+    traceButton.onClick = [this]
+    {
+        processor.setTraceRecording (traceButton.getToggleState());
+        traceButton.setToggleState (processor.isTraceRecording(), juce::dontSendNotification);
+    };
+
+    setWantsKeyboardFocus (true);
+
     darkTheme = false;
-    teleprompter.setText (processor.getLyricsText());
     teleprompter.setTheme (darkTheme);
+    teleprompter.setText (processor.getLyricsText());
+    setNumColumns (processor.getNumLyricsColumns());
+
+    for (int i = 0; i < teleprompter.getNumColumns(); ++i)
+        if (processor.getLyricsFile (i).existsAsFile())
+            scriptWatchers[(size_t) i].watch (processor.getLyricsFile (i));
 
     addAndMakeVisible (autoScrollButton);
     addAndMakeVisible (resetOnStopButton);
@@ -92,6 +171,14 @@ RosettaPrompterAudioProcessorEditor::RosettaPrompterAudioProcessorEditor (Rosett
     addAndMakeVisible (importButton);
     addAndMakeVisible (themeBox);
     addAndMakeVisible (openCacheButton);
+    addAndMakeVisible (columnsBox);
+    addAndMakeVisible (importColumnBox);
+    addAndMakeVisible (oscButton);
+    addAndMakeVisible (timingModeBox);
+    addAndMakeVisible (recordTimingButton);
+    addAndMakeVisible (tapButton);
+    addAndMakeVisible (clearTimingButton);
+    addAndMakeVisible (traceButton);
     addAndMakeVisible (cachePathLabel);
 
     cachePathLabel.setText ("Cache: " + RosettaPrompterAudioProcessor::getCacheFolder().getFullPathName(),
@@ -103,14 +190,56 @@ RosettaPrompterAudioProcessorEditor::RosettaPrompterAudioProcessorEditor (Rosett
     resetOnStopAttachment = std::make_unique<ButtonAttachment> (processor.apvts, RosettaPrompterAudioProcessor::ParamIDs::resetOnStop, resetOnStopButton);
     fontSizeAttachment = std::make_unique<SliderAttachment> (processor.apvts, RosettaPrompterAudioProcessor::ParamIDs::fontSize, fontSizeSlider);
     manualScrollAttachment = std::make_unique<SliderAttachment> (processor.apvts, RosettaPrompterAudioProcessor::ParamIDs::manualScroll, manualScrollSlider);
+    timingModeAttachment = std::make_unique<ComboBoxAttachment> (processor.apvts, RosettaPrompterAudioProcessor::ParamIDs::timingMode, timingModeBox);
 
     refreshLabels();
-
-    startTimerHz (30);
 }
 
 RosettaPrompterAudioProcessorEditor::~RosettaPrompterAudioProcessorEditor() = default;
 
+void RosettaPrompterAudioProcessorEditor::visibilityChanged()
+{
+    updateTimerState();
+}
+
+void RosettaPrompterAudioProcessorEditor::parentHierarchyChanged()
+{
+    updateTimerState();
+}
+
+bool RosettaPrompterAudioProcessorEditor::keyPressed (const juce::KeyPress& key)
+{
+    // A space typed into the lyrics is text, not a tap.
+    const bool editingText = dynamic_cast<juce::TextEditor*> (juce::Component::getCurrentlyFocusedComponent()) != nullptr;
+
+    if (key == juce::KeyPress::spaceKey && processor.isTimingRecording() && ! editingText)
+    {
+        tapTiming();
+        return true;
+    }
+
+    return false;
+}
+
+void RosettaPrompterAudioProcessorEditor::tapTiming()
+{
+    if (processor.recordTimingTap())
+        updateTransportDrivenUI();
+}
+
+void RosettaPrompterAudioProcessorEditor::updateTimerState()
+{
+    if (isVisible() && getPeer() != nullptr)
+    {
+        if (! isTimerRunning())
+            startTimerHz (30);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
 void RosettaPrompterAudioProcessorEditor::paint (juce::Graphics& g)
 {
     const auto background = darkTheme ? juce::Colour (0xff0f1115) : juce::Colour (0xfff5e94b);
@@ -138,8 +267,18 @@ void RosettaPrompterAudioProcessorEditor::resized()
     manualScrollSlider.setBounds (row2);
 
     auto row3 = controls.removeFromTop (24);
+    columnsBox.setBounds (row3.removeFromLeft (120));
+    importColumnBox.setBounds (row3.removeFromLeft (160));
+    oscButton.setBounds (row3.removeFromLeft (120));
+    timingModeBox.setBounds (row3.removeFromLeft (150));
     cachePathLabel.setBounds (row3);
 
+    auto row4 = controls.removeFromTop (28).withTrimmedTop (4);
+    recordTimingButton.setBounds (row4.removeFromLeft (130));
+    tapButton.setBounds (row4.removeFromLeft (140));
+    clearTimingButton.setBounds (row4.removeFromLeft (120));
+    traceButton.setBounds (row4.removeFromLeft (130).withTrimmedLeft (10));
+
     teleprompter.setBounds (bounds);
 }
 
@@ -152,7 +291,13 @@ void RosettaPrompterAudioProcessorEditor::timerCallback()
         lastFontSize = fontSize;
     }
 
+    processor.collectTimingTaps();
     refreshLabels();
+    refreshLyrics();
+
+    const auto meter = processor.getInputMeter().getSnapshot();
+    teleprompter.setMeterLevels (meter.peakDb, meter.rmsDb, meter.shortTermLufs);
+
     updateTransportDrivenUI();
 
     if (processor.consumeStoppedFlag())
@@ -168,27 +313,22 @@ void RosettaPrompterAudioProcessorEditor::timerCallback()
 
 void RosettaPrompterAudioProcessorEditor::updateTransportDrivenUI()
 {
-    const float startBar = processor.getParameterValue (RosettaPrompterAudioProcessor::ParamIDs::startBar);
-    const float endBar = processor.getParameterValue (RosettaPrompterAudioProcessor::ParamIDs::endBar);
     const bool autoScrollOn = processor.getParameterValue (RosettaPrompterAudioProcessor::ParamIDs::autoScroll) > 0.5f;
 
-    if (processor.isPlayheadValid())
-    {
-        const double barPos = processor.getLastBarPosition();
-        double progress = 0.0;
-        if (endBar > startBar)
-            progress = (barPos - startBar) / static_cast<double> (endBar - startBar);
-
-        progress = juce::jlimit (0.0, 1.0, progress);
+    timeline.setNumLines (teleprompter.getNumLines());
+    const auto active = processor.followTransport (timeline);
 
-        const int numLines = teleprompter.getNumLines();
-        const int maxIndex = juce::jmax (0, numLines - 1);
-        const int activeLine = static_cast<int> (std::floor (progress * maxIndex));
-
-        teleprompter.setActiveLine (activeLine);
+    if (active.isValid)
+    {
+        teleprompter.setActiveLine (active.position.line, active.position.progress);
 
         if (autoScrollOn)
-            teleprompter.setScrollTargetForLine (activeLine);
+        {
+            teleprompter.setScrollTargetForLine (active.position.line);
+
+            if (active.positionJumped)
+                teleprompter.snapToScrollTarget();
+        }
     }
 
     if (! autoScrollOn)
@@ -198,6 +338,53 @@ void RosettaPrompterAudioProcessorEditor::updateTransportDrivenUI()
     }
 }
 
+void RosettaPrompterAudioProcessorEditor::refreshLyrics()
+{
+    // Lyrics can change without the editor, for example a script loaded over OSC.
+    if (appliedLyricsRevision == processor.getLyricsRevision())
+        return;
+
+    appliedLyricsRevision = processor.getLyricsRevision();
+
+    for (int i = 0; i < teleprompter.getNumColumns(); ++i)
+    {
+        const auto text = processor.getLyricsText (i);
+        if (text != teleprompter.getColumnText (i))
+            teleprompter.setColumnText (i, text);
+
+        const auto file = processor.getLyricsFile (i);
+        if (file.existsAsFile() && file != scriptWatchers[(size_t) i].getFile())
+            scriptWatchers[(size_t) i].watch (file);
+    }
+}
+
+void RosettaPrompterAudioProcessorEditor::importLyricsFile (const juce::File& file, int column)
+{
+    if (! processor.loadLyricsFile (file, column))
+        return;
+
+    if (column >= teleprompter.getNumColumns())
+        setNumColumns (column + 1);
+
+    teleprompter.setColumnText (column, processor.getLyricsText (column));
+    scriptWatchers[(size_t) column].watch (file);
+}
+
+void RosettaPrompterAudioProcessorEditor::setNumColumns (int numColumns)
+{
+    const int previousColumns = teleprompter.getNumColumns();
+
+    processor.setNumLyricsColumns (numColumns);
+    teleprompter.setNumColumns (processor.getNumLyricsColumns());
+    columnsBox.setSelectedId (teleprompter.getNumColumns(), juce::dontSendNotification);
+
+    for (int i = previousColumns; i < teleprompter.getNumColumns(); ++i)
+        teleprompter.setColumnText (i, processor.getLyricsText (i));
+
+    for (int i = teleprompter.getNumColumns(); i < TeleprompterComponent::maxColumns; ++i)
+        scriptWatchers[(size_t) i].stopWatching();
+}
+
 void RosettaPrompterAudioProcessorEditor::refreshLabels()
 {
     const float startBar = processor.getParameterValue (RosettaPrompterAudioProcessor::ParamIDs::startBar);
@@ -205,4 +392,9 @@ void RosettaPrompterAudioProcessorEditor::refreshLabels()
 
     startBarLabel.setText ("Start: " + juce::String (startBar, 2), juce::dontSendNotification);
     endBarLabel.setText ("End: " + juce::String (endBar, 2), juce::dontSendNotification);
+
+    const bool recording = processor.isTimingRecording();
+    recordTimingButton.setToggleState (recording, juce::dontSendNotification);
+    tapButton.setEnabled (recording);
+    tapButton.setButtonText (recording ? "Tap Line " + juce::String (processor.getNextTimingLine() + 1) : "Tap");
 }
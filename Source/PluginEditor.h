@@ -3,6 +3,8 @@
 #include <juce_gui_extra/juce_gui_extra.h>
 #include "PluginProcessor.h"
 #include "TeleprompterComponent.h"
+#include "PrompterTimeline.h"
+#include "ScriptFileWatcher.h"
 
 class RosettaPrompterAudioProcessorEditor : public juce::AudioProcessorEditor, private juce::Timer
 {
@@ -12,15 +14,26 @@ public:
 
     void paint (juce::Graphics&) override;
     void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
+    bool keyPressed (const juce::KeyPress& key) override;
 
 private:
     void timerCallback() override;
+    void updateTimerState();
     void updateTransportDrivenUI();
     void refreshLabels();
+    void tapTiming();
+    void setNumColumns (int numColumns);
+    void refreshLyrics();
+    void importLyricsFile (const juce::File& file, int column);
 
     RosettaPrompterAudioProcessor& processor;
 
     TeleprompterComponent teleprompter;
+    PrompterTimeline timeline;
+    std::array<ScriptFileWatcher, TeleprompterComponent::maxColumns> scriptWatchers;
+    std::unique_ptr<juce::FileChooser> fileChooser;
 
     juce::ToggleButton autoScrollButton { "Auto Scroll" };
     juce::ToggleButton resetOnStopButton { "Reset On Stop" };
@@ -35,17 +48,28 @@ private:
     juce::TextButton importButton { "Import .txt" };
     juce::ComboBox themeBox;
     juce::TextButton openCacheButton { "Export Track (Open Cache)" };
+    juce::ComboBox columnsBox;
+    juce::ComboBox importColumnBox;
+    juce::ToggleButton oscButton { "OSC Remote" };
+    juce::ComboBox timingModeBox;
+    juce::ToggleButton recordTimingButton { "Record Timing" };
+    juce::TextButton tapButton { "Tap" };
+    juce::TextButton clearTimingButton { "Clear Timing" };
+    juce::ToggleButton traceButton { "Record Trace" };
     juce::Label cachePathLabel;
 
     using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
     using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
+    using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
 
     std::unique_ptr<ButtonAttachment> autoScrollAttachment;
     std::unique_ptr<ButtonAttachment> resetOnStopAttachment;
     std::unique_ptr<SliderAttachment> fontSizeAttachment;
     std::unique_ptr<SliderAttachment> manualScrollAttachment;
+    std::unique_ptr<ComboBoxAttachment> timingModeAttachment;
 
     float lastFontSize = 0.0f;
+    int appliedLyricsRevision = -1;
     bool darkTheme = true;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RosettaPrompterAudioProcessorEditor)
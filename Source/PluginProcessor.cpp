@@ -1,16 +1,25 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "LineDiff.h"
+#include <algorithm>
+#include <cmath>
+
+static std::atomic<int> nextInstanceNumber { 1 };
 
 RosettaPrompterAudioProcessor::RosettaPrompterAudioProcessor()
     : AudioProcessor (BusesProperties()
         .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
         .withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
-      apvts (*this, nullptr, "PARAMS", createParameterLayout())
+      apvts (*this, nullptr, "PARAMS", createParameterLayout()),
+      instanceNumber (nextInstanceNumber++)
 {
-    logMessage ("Processor constructed");
 }
 
-RosettaPrompterAudioProcessor::~RosettaPrompterAudioProcessor() = default;
+RosettaPrompterAudioProcessor::~RosettaPrompterAudioProcessor()
+{
+    stopTimer();
+    cancelPendingUpdate();
+}
 
 const juce::String RosettaPrompterAudioProcessor::getName() const
 {
@@ -19,7 +28,7 @@ const juce::String RosettaPrompterAudioProcessor::getName() const
 
 bool RosettaPrompterAudioProcessor::acceptsMidi() const
 {
-    return false;
+    return true;
 }
 
 bool RosettaPrompterAudioProcessor::producesMidi() const
@@ -65,11 +74,29 @@ void RosettaPrompterAudioProcessor::changeProgramName (int index, const juce::St
 
 void RosettaPrompterAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    juce::ignoreUnused (sampleRate, samplesPerBlock);
+    inputMeter.prepare (sampleRate, samplesPerBlock, getTotalNumInputChannels());
+
+    // Most hosts re-prepare after switching to offline rendering, so the bounce
+    // session can be set up here before the first block arrives.
+    if (isNonRealtime() && ! bounceWriter.hasSession())
+        prepareBounce();
 }
 
 void RosettaPrompterAudioProcessor::releaseResources()
 {
+    bounceWriter.end();
+}
+
+void RosettaPrompterAudioProcessor::setNonRealtime (bool shouldBeNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime (shouldBeNonRealtime);
+
+    // Copying the lyrics allocates and locks, so the session is prepared on the
+    // message thread, or in prepareToPlay if the host re-prepares first.
+    if (shouldBeNonRealtime)
+        triggerAsyncUpdate();
+    else
+        bounceWriter.end();
 }
 
 bool RosettaPrompterAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -85,8 +112,6 @@ bool RosettaPrompterAudioProcessor::isBusesLayoutSupported (const BusesLayout& l
 
 void RosettaPrompterAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused (midiMessages);
-
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -94,7 +119,13 @@ void RosettaPrompterAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updatePlayheadInfo();
+    inputMeter.process (buffer, totalNumInputChannels);
+
+    updatePlayheadInfo (buffer.getNumSamples());
+    captureMidiTaps (midiMessages);
+
+    if (isNonRealtime())
+        pushBounceBlock (buffer.getNumSamples());
 }
 
 bool RosettaPrompterAudioProcessor::hasEditor() const
@@ -104,14 +135,40 @@ bool RosettaPrompterAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* RosettaPrompterAudioProcessor::createEditor()
 {
-    logMessage ("createEditor called");
     return new RosettaPrompterAudioProcessorEditor (*this);
 }
 
 void RosettaPrompterAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
     auto state = apvts.copyState();
-    state.setProperty ("lyricsText", lyricsText, nullptr);
+
+    const juce::ScopedLock lock (timingDataLock);
+    state.setProperty ("numColumns", numLyricsColumns, nullptr);
+
+    for (int i = 0; i < maxLyricsColumns; ++i)
+    {
+        state.setProperty (getLyricsPropertyID (i), lyricsColumns[(size_t) i], nullptr);
+        state.setProperty (getLyricsFilePropertyID (i), lyricsFiles[(size_t) i], nullptr);
+    }
+
+    juce::StringArray weights;
+    for (const auto& [line, weight] : lineWeightOverrides)
+        weights.add (juce::String (line) + ":" + juce::String (weight));
+
+    state.setProperty ("lineWeights", weights.joinIntoString (";"), nullptr);
+
+    juce::StringArray startBars;
+    for (auto bar : timingMap)
+        startBars.add (juce::String (bar, 6));
+
+    state.setProperty ("timingMap", startBars.joinIntoString (" "), nullptr);
+
+    const juce::ScopedLock oscLock (oscStateLock);
+    state.setProperty ("oscEnabled", oscEnabled.load(), nullptr);
+    state.setProperty ("oscListenPort", oscSettings.listenPort, nullptr);
+    state.setProperty ("oscTargetHost", oscSettings.targetHost, nullptr);
+    state.setProperty ("oscTargetPort", oscSettings.targetPort, nullptr);
+    state.setProperty ("oscRateHz", oscSettings.broadcastRateHz, nullptr);
 
     if (auto xml = state.createXml())
         copyXmlToBinary (*xml, destData);
@@ -124,7 +181,37 @@ void RosettaPrompterAudioProcessor::setStateInformation (const void* data, int s
         if (xml->hasTagName (apvts.state.getType()))
         {
             apvts.replaceState (juce::ValueTree::fromXml (*xml));
-            lyricsText = apvts.state.getProperty ("lyricsText").toString();
+
+            const OscRemote::Settings defaults;
+            OscRemote::Settings restoredOscSettings;
+            restoredOscSettings.listenPort = apvts.state.getProperty ("oscListenPort", defaults.listenPort);
+            restoredOscSettings.targetHost = apvts.state.getProperty ("oscTargetHost", defaults.targetHost).toString();
+            restoredOscSettings.targetPort = apvts.state.getProperty ("oscTargetPort", defaults.targetPort);
+            restoredOscSettings.broadcastRateHz = apvts.state.getProperty ("oscRateHz", defaults.broadcastRateHz);
+            queueOscState (apvts.state.getProperty ("oscEnabled", false), restoredOscSettings);
+
+            const juce::ScopedLock lock (timingDataLock);
+            numLyricsColumns = juce::jlimit (1, maxLyricsColumns, static_cast<int> (apvts.state.getProperty ("numColumns", 1)));
+
+            for (int i = 0; i < maxLyricsColumns; ++i)
+            {
+                lyricsColumns[(size_t) i] = apvts.state.getProperty (getLyricsPropertyID (i)).toString();
+                lyricsFiles[(size_t) i] = apvts.state.getProperty (getLyricsFilePropertyID (i)).toString();
+            }
+
+            lineWeightOverrides.clear();
+            for (auto& entry : juce::StringArray::fromTokens (apvts.state.getProperty ("lineWeights").toString(), ";", {}))
+                if (entry.containsChar (':'))
+                    lineWeightOverrides[entry.upToFirstOccurrenceOf (":", false, false).getIntValue()]
+                        = entry.fromFirstOccurrenceOf (":", false, false).getDoubleValue();
+
+            timingMap.clear();
+            for (auto& bar : juce::StringArray::fromTokens (apvts.state.getProperty ("timingMap").toString(), " ", {}))
+                timingMap.push_back (bar.getDoubleValue());
+
+            ++timingDataRevision;
+
+            ++lyricsRevision;
         }
     }
 }
@@ -143,6 +230,8 @@ juce::AudioProcessorValueTreeState::ParameterLayout RosettaPrompterAudioProcesso
     params.push_back (std::make_unique<juce::AudioParameterFloat> (ParamIDs::endBar, "End Bar",
         juce::NormalisableRange<float> (0.0f, 4096.0f, 0.01f), 64.0f));
     params.push_back (std::make_unique<juce::AudioParameterBool> (ParamIDs::resetOnStop, "Reset On Stop", false));
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (ParamIDs::timingMode, "Timing Mode",
+        juce::StringArray { "Linear", "Syllable Weighted", "Tapped" }, 0));
 
     return { params.begin(), params.end() };
 }
@@ -155,11 +244,21 @@ float RosettaPrompterAudioProcessor::getParameterValue (const juce::String& para
     return 0.0f;
 }
 
+const InputMeter& RosettaPrompterAudioProcessor::getInputMeter() const
+{
+    return inputMeter;
+}
+
 bool RosettaPrompterAudioProcessor::isPlayheadValid() const
 {
     return playheadValid.load();
 }
 
+bool RosettaPrompterAudioProcessor::isTransportPlaying() const
+{
+    return isPlaying.load();
+}
+
 double RosettaPrompterAudioProcessor::getLastBarPosition() const
 {
     return lastBarPosition.load();
@@ -170,19 +269,92 @@ bool RosettaPrompterAudioProcessor::consumeStoppedFlag()
     return stoppedFlag.exchange (false);
 }
 
-bool RosettaPrompterAudioProcessor::setStartBarToCurrent()
+bool RosettaPrompterAudioProcessor::popTransportEvent (TransportEvent& event)
 {
-    if (! playheadValid.load())
+    const auto scope = transportEventFifo.read (1);
+    if (scope.blockSize1 <= 0)
         return false;
 
-    const auto value = static_cast<float> (lastBarPosition.load());
-    if (auto* param = apvts.getParameter (ParamIDs::startBar))
+    event = transportEvents[(size_t) scope.startIndex1];
+    return true;
+}
+
+void RosettaPrompterAudioProcessor::syncTimeline (PrompterTimeline& timeline) const
+{
+    const int timingMode = juce::roundToInt (getParameterValue (ParamIDs::timingMode));
+
+    timeline.setCalibration (getParameterValue (ParamIDs::startBar), getParameterValue (ParamIDs::endBar));
+    timeline.setMode (timingMode == 1 ? PrompterTimeline::Mode::weighted : PrompterTimeline::Mode::linear);
+
+    const juce::ScopedLock lock (timingDataLock);
+    const bool useTimingMap = timingMode == 2 && ! timingMap.empty();
+
+    // This runs on every UI tick, so the weights and the map are only copied
+    // when they, or the choice of the map, changed since the last sync.
+    if (timeline.getSourceRevision() == timingDataRevision && timeline.hasLineStartBars() == useTimingMap)
+        return;
+
+    timeline.setWeightOverrides (lineWeightOverrides);
+
+    if (useTimingMap)
+        timeline.setLineStartBars (timingMap);
+    else
+        timeline.clearLineStartBars();
+
+    timeline.setSourceRevision (timingDataRevision);
+}
+
+RosettaPrompterAudioProcessor::ActivePosition RosettaPrompterAudioProcessor::followTransport (PrompterTimeline& timeline,
+                                                                                              bool consumeEvents)
+{
+    ActivePosition active;
+    bool positionJumped = false;
+    TransportEvent event;
+
+    while (consumeEvents && popTransportEvent (event))
+        positionJumped = true;
+
+    if (isPlaying.load())
+        remoteCueLine = -1;
+
+    if (remoteCueLine >= 0)
     {
-        param->setValueNotifyingHost (param->convertTo0to1 (value));
-        return true;
+        active.position = { juce::jmin (remoteCueLine, timeline.getNumLines() - 1), 0.0 };
+        active.isValid = true;
+    }
+    else if (timingRecording.load())
+    {
+        // While recording, follow the taps: the last stamped line stays lit.
+        active.position = { juce::jmax (0, getNextTimingLine() - 1), 0.0 };
+        active.isValid = true;
+    }
+    else if (playheadValid.load())
+    {
+        syncTimeline (timeline);
+        active.position = timeline.getPositionAtBar (lastBarPosition.load());
+        active.isValid = true;
+        active.positionJumped = positionJumped;
     }
 
-    return false;
+    return active;
+}
+
+void RosettaPrompterAudioProcessor::setRemoteCueLine (int line)
+{
+    remoteCueLine = juce::jmax (-1, line);
+}
+
+int RosettaPrompterAudioProcessor::getRemoteCueLine() const
+{
+    return remoteCueLine;
+}
+
+bool RosettaPrompterAudioProcessor::setStartBarToCurrent()
+{
+    if (! playheadValid.load())
+        return false;
+
+    return setStartBar (static_cast<float> (lastBarPosition.load()));
 }
 
 bool RosettaPrompterAudioProcessor::setEndBarToCurrent()
@@ -190,8 +362,22 @@ bool RosettaPrompterAudioProcessor::setEndBarToCurrent()
     if (! playheadValid.load())
         return false;
 
-    const auto value = static_cast<float> (lastBarPosition.load());
-    if (auto* param = apvts.getParameter (ParamIDs::endBar))
+    return setEndBar (static_cast<float> (lastBarPosition.load()));
+}
+
+bool RosettaPrompterAudioProcessor::setStartBar (float bar)
+{
+    return setParameterValue (ParamIDs::startBar, bar);
+}
+
+bool RosettaPrompterAudioProcessor::setEndBar (float bar)
+{
+    return setParameterValue (ParamIDs::endBar, bar);
+}
+
+bool RosettaPrompterAudioProcessor::setParameterValue (const juce::String& paramID, float value)
+{
+    if (auto* param = apvts.getParameter (paramID))
     {
         param->setValueNotifyingHost (param->convertTo0to1 (value));
         return true;
@@ -200,20 +386,425 @@ bool RosettaPrompterAudioProcessor::setEndBarToCurrent()
     return false;
 }
 
-void RosettaPrompterAudioProcessor::setLyricsText (const juce::String& text)
+void RosettaPrompterAudioProcessor::setTimingRecording (bool shouldRecord)
+{
+    if (! shouldRecord)
+        collectTimingTaps();
+
+    const juce::ScopedLock lock (timingDataLock);
+    timingLineLimit = juce::StringArray::fromLines (lyricsColumns[0]).size();
+    timingRecording.store (shouldRecord && timingLineLimit > 0);
+}
+
+bool RosettaPrompterAudioProcessor::isTimingRecording() const
+{
+    return timingRecording.load();
+}
+
+bool RosettaPrompterAudioProcessor::recordTimingTap()
+{
+    const double tapTimeNs = getTimeNs();
+
+    if (! timingRecording.load())
+        return false;
+
+    TransportSnapshot snapshot;
+    {
+        const juce::SpinLock::ScopedLockType lock (transportSnapshotLock);
+        snapshot = transportSnapshot;
+    }
+
+    // A snapshot older than a second means the host has stopped calling us.
+    if (! snapshot.isValid || ! snapshot.isPlaying || tapTimeNs - snapshot.timeNs > 1.0e9)
+        return false;
+
+    addTimingTap (snapshot.getBarAtTime (tapTimeNs));
+    return true;
+}
+
+int RosettaPrompterAudioProcessor::collectTimingTaps()
+{
+    int numTaps = 0;
+
+    for (;;)
+    {
+        const auto scope = timingTapFifo.read (1);
+        if (scope.blockSize1 <= 0)
+            break;
+
+        if (timingRecording.load())
+        {
+            addTimingTap (timingTaps[(size_t) scope.startIndex1]);
+            ++numTaps;
+        }
+    }
+
+    return numTaps;
+}
+
+int RosettaPrompterAudioProcessor::getNextTimingLine() const
+{
+    const juce::ScopedLock lock (timingDataLock);
+    return static_cast<int> (timingMap.size());
+}
+
+std::vector<double> RosettaPrompterAudioProcessor::getTimingMap() const
+{
+    const juce::ScopedLock lock (timingDataLock);
+    return timingMap;
+}
+
+void RosettaPrompterAudioProcessor::clearTimingMap()
+{
+    const juce::ScopedLock lock (timingDataLock);
+    timingMap.clear();
+    ++timingDataRevision;
+}
+
+void RosettaPrompterAudioProcessor::setTimingMap (std::vector<double> startBars)
+{
+    const juce::ScopedLock lock (timingDataLock);
+    timingMap = std::move (startBars);
+    std::sort (timingMap.begin(), timingMap.end());
+    ++timingDataRevision;
+}
+
+void RosettaPrompterAudioProcessor::addTimingTap (double bar)
+{
+    const juce::ScopedLock lock (timingDataLock);
+
+    // Tapping behind already recorded lines (after a loop wrap or a seek back)
+    // re-records from that point, so a section can be punched in again.
+    while (! timingMap.empty() && timingMap.back() >= bar)
+        timingMap.pop_back();
+
+    if (static_cast<int> (timingMap.size()) < timingLineLimit)
+        timingMap.push_back (bar);
+
+    ++timingDataRevision;
+
+    if (static_cast<int> (timingMap.size()) >= timingLineLimit)
+        timingRecording.store (false);
+}
+
+void RosettaPrompterAudioProcessor::setLyricsText (const juce::String& text, int column)
+{
+    const juce::ScopedLock lock (timingDataLock);
+
+    if (! juce::isPositiveAndBelow (column, maxLyricsColumns) || lyricsColumns[(size_t) column] == text)
+        return;
+
+    // Weights belong to lines of the first column, so they follow those lines
+    // when others are inserted or removed above them.
+    if (column == 0 && ! lineWeightOverrides.empty())
+    {
+        const auto diff = LineDiff::compute (juce::StringArray::fromLines (lyricsColumns[0]),
+                                             juce::StringArray::fromLines (text));
+        std::map<int, double> shifted;
+
+        for (const auto& [line, weight] : lineWeightOverrides)
+        {
+            const int newLine = diff.mapLine (line);
+            if (newLine >= 0)
+                shifted[newLine] = weight;
+        }
+
+        lineWeightOverrides = std::move (shifted);
+        ++timingDataRevision;
+    }
+
+    lyricsColumns[(size_t) column] = text;
+    ++lyricsRevision;
+}
+
+juce::String RosettaPrompterAudioProcessor::getLyricsText (int column) const
+{
+    const juce::ScopedLock lock (timingDataLock);
+
+    if (juce::isPositiveAndBelow (column, maxLyricsColumns))
+        return lyricsColumns[(size_t) column];
+
+    return {};
+}
+
+void RosettaPrompterAudioProcessor::setLyricsFile (const juce::File& file, int column)
+{
+    const juce::ScopedLock lock (timingDataLock);
+
+    if (juce::isPositiveAndBelow (column, maxLyricsColumns))
+        lyricsFiles[(size_t) column] = file.getFullPathName();
+}
+
+juce::File RosettaPrompterAudioProcessor::getLyricsFile (int column) const
+{
+    const juce::ScopedLock lock (timingDataLock);
+
+    if (juce::isPositiveAndBelow (column, maxLyricsColumns) && juce::File::isAbsolutePath (lyricsFiles[(size_t) column]))
+        return juce::File (lyricsFiles[(size_t) column]);
+
+    return {};
+}
+
+bool RosettaPrompterAudioProcessor::loadLyricsFile (const juce::File& file, int column)
+{
+    if (! file.existsAsFile() || ! juce::isPositiveAndBelow (column, maxLyricsColumns))
+        return false;
+
+    setLyricsText (file.loadFileAsString(), column);
+    setLyricsFile (file, column);
+    return true;
+}
+
+int RosettaPrompterAudioProcessor::getLyricsRevision() const
+{
+    return lyricsRevision.load();
+}
+
+void RosettaPrompterAudioProcessor::setLineWeightOverride (int line, double weight)
+{
+    const juce::ScopedLock lock (timingDataLock);
+
+    if (line >= 0)
+    {
+        lineWeightOverrides[line] = juce::jmax (0.0, weight);
+        ++timingDataRevision;
+    }
+}
+
+void RosettaPrompterAudioProcessor::clearLineWeightOverride (int line)
+{
+    const juce::ScopedLock lock (timingDataLock);
+
+    if (lineWeightOverrides.erase (line) > 0)
+        ++timingDataRevision;
+}
+
+std::map<int, double> RosettaPrompterAudioProcessor::getLineWeightOverrides() const
+{
+    const juce::ScopedLock lock (timingDataLock);
+    return lineWeightOverrides;
+}
+
+void RosettaPrompterAudioProcessor::setNumLyricsColumns (int numColumns)
+{
+    const juce::ScopedLock lock (timingDataLock);
+    numLyricsColumns = juce::jlimit (1, maxLyricsColumns, numColumns);
+}
+
+int RosettaPrompterAudioProcessor::getNumLyricsColumns() const
+{
+    const juce::ScopedLock lock (timingDataLock);
+    return numLyricsColumns;
+}
+
+bool RosettaPrompterAudioProcessor::setOscEnabled (bool shouldBeEnabled)
+{
+    stopTimer();
+    oscRemote.stop();
+    oscRequested = shouldBeEnabled;
+    oscEnabled = shouldBeEnabled && oscRemote.start (oscSettings);
+
+    if (oscEnabled.load())
+        startTimerHz (30);
+    else if (shouldBeEnabled)
+        logMessage ("OSC remote could not listen on port " + juce::String (oscSettings.listenPort)
+                    + " or reach " + oscSettings.targetHost + ":" + juce::String (oscSettings.targetPort));
+
+    return oscEnabled.load() == shouldBeEnabled;
+}
+
+bool RosettaPrompterAudioProcessor::isOscEnabled() const
+{
+    return oscEnabled.load();
+}
+
+void RosettaPrompterAudioProcessor::queueOscState (bool shouldBeEnabled, const OscRemote::Settings& settings)
+{
+    {
+        const juce::ScopedLock lock (oscStateLock);
+        pendingOscSettings = settings;
+        pendingOscEnabled = shouldBeEnabled;
+    }
+
+    oscStatePending.store (true);
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        applyPendingOscState();
+    else
+        triggerAsyncUpdate();
+}
+
+void RosettaPrompterAudioProcessor::applyPendingOscState()
+{
+    if (! oscStatePending.exchange (false))
+        return;
+
+    OscRemote::Settings settings;
+    bool shouldBeEnabled = false;
+
+    {
+        const juce::ScopedLock lock (oscStateLock);
+        settings = pendingOscSettings;
+        shouldBeEnabled = pendingOscEnabled;
+    }
+
+    // Hosts restore state often, sometimes many times a second; the sockets
+    // are only reopened when the restored remote differs from the current one.
+    if (shouldBeEnabled == oscRequested && settings == oscSettings)
+        return;
+
+    {
+        const juce::ScopedLock lock (oscStateLock);
+        oscSettings = settings;
+    }
+
+    setOscEnabled (shouldBeEnabled);
+}
+
+OscRemote& RosettaPrompterAudioProcessor::getOscRemote()
+{
+    return oscRemote;
+}
+
+void RosettaPrompterAudioProcessor::timerCallback()
+{
+    updateRemoteControl();
+}
+
+void RosettaPrompterAudioProcessor::handleAsyncUpdate()
+{
+    applyPendingOscState();
+
+    if (isNonRealtime() && ! bounceWriter.hasSession())
+        prepareBounce();
+}
+
+void RosettaPrompterAudioProcessor::updateRemoteControl()
+{
+    updateRemoteLines();
+    handleRemoteCommands();
+
+    const auto active = followTransport (remoteTimeline, false);
+    if (active.isValid)
+        remoteActiveLine = active.position.line;
+
+    oscRemote.publishActiveLine (remoteActiveLine, remoteTimeline.getNumLines());
+}
+
+void RosettaPrompterAudioProcessor::updateRemoteLines()
 {
-    lyricsText = text;
+    if (remoteLyricsRevision == lyricsRevision.load())
+        return;
+
+    remoteLyricsRevision = lyricsRevision.load();
+
+    const auto lines = juce::StringArray::fromLines (getLyricsText());
+    remoteTimeline.setLines (lines);
+    remoteTimeline.setNumLines (lines.size());
 }
 
-juce::String RosettaPrompterAudioProcessor::getLyricsText() const
+void RosettaPrompterAudioProcessor::handleRemoteCommands()
 {
-    return lyricsText;
+    using Command = OscRemote::Command;
+    Command command;
+
+    while (oscRemote.popCommand (command))
+    {
+        const int lastLine = remoteTimeline.getNumLines() - 1;
+        const int currentLine = remoteCueLine >= 0 ? remoteCueLine : remoteActiveLine;
+
+        switch (command.type)
+        {
+            case Command::Type::nextLine:
+                setRemoteCueLine (juce::jmin (lastLine, currentLine + 1));
+                break;
+
+            case Command::Type::previousLine:
+                setRemoteCueLine (juce::jmax (0, currentLine - 1));
+                break;
+
+            case Command::Type::jumpToLine:
+                setRemoteCueLine (juce::jlimit (0, lastLine, command.line));
+                break;
+
+            case Command::Type::setStartBar:
+                setStartBar (command.value);
+                break;
+
+            case Command::Type::setEndBar:
+                setEndBar (command.value);
+                break;
+
+            case Command::Type::setLineWeight:
+                if (command.value > 0.0f)
+                    setLineWeightOverride (command.line, command.value);
+                else
+                    clearLineWeightOverride (command.line);
+                break;
+
+            case Command::Type::loadScript:
+                if (juce::File::isAbsolutePath (command.path))
+                    loadLyricsFile (juce::File (command.path));
+
+                updateRemoteLines();
+                break;
+        }
+    }
 }
 
-void RosettaPrompterAudioProcessor::updatePlayheadInfo()
+void RosettaPrompterAudioProcessor::setTraceRecording (bool shouldRecord)
+{
+    if (! shouldRecord)
+    {
+        traceRecorder.stop();
+        return;
+    }
+
+    const auto file = createCacheFolder()
+        .getChildFile ("transport-" + juce::Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S"))
+        .withFileExtension (TransportTraceRecorder::fileExtension);
+
+    if (! traceRecorder.start (file.getNonexistentSibling()))
+        logMessage ("Could not write transport trace " + file.getFullPathName());
+}
+
+bool RosettaPrompterAudioProcessor::isTraceRecording() const
+{
+    return traceRecorder.isRecording();
+}
+
+juce::File RosettaPrompterAudioProcessor::getTraceFile() const
+{
+    return traceRecorder.getFile();
+}
+
+juce::Identifier RosettaPrompterAudioProcessor::getLyricsPropertyID (int column)
+{
+    static const juce::Identifier ids[] = { "lyricsText", "lyricsText1", "lyricsText2" };
+    static_assert (std::size (ids) == maxLyricsColumns, "One state property per lyrics column");
+    return ids[column];
+}
+
+juce::Identifier RosettaPrompterAudioProcessor::getLyricsFilePropertyID (int column)
+{
+    static const juce::Identifier ids[] = { "lyricsFile", "lyricsFile1", "lyricsFile2" };
+    static_assert (std::size (ids) == maxLyricsColumns, "One state property per lyrics column");
+    return ids[column];
+}
+
+void RosettaPrompterAudioProcessor::updatePlayheadInfo (int numSamples)
 {
     bool gotInfo = false;
     bool isPlayingNow = false;
+    bool isLooping = false;
+    double ppq = 0.0;
+    double bpm = 120.0;
+    double loopStartPpq = 0.0;
+    double loopEndPpq = 0.0;
+    double hostTimeNs = -1.0;
+    int numerator = 4;
+    const double wallTimeNs = getTimeNs();
+    double blockTimeNs = wallTimeNs;
 
     if (auto* playHead = getPlayHead())
     {
@@ -221,35 +812,100 @@ void RosettaPrompterAudioProcessor::updatePlayheadInfo()
         if (auto position = playHead->getPosition())
         {
             isPlayingNow = position->getIsPlaying();
+            isLooping = position->getIsLooping();
 
-            int numerator = 4;
             if (auto timeSig = position->getTimeSignature())
                 numerator = timeSig->numerator > 0 ? timeSig->numerator : 4;
 
-            if (auto ppq = position->getPpqPosition())
+            if (auto hostBpm = position->getBpm())
+                bpm = *hostBpm;
+
+            if (auto loopPoints = position->getLoopPoints())
+            {
+                loopStartPpq = loopPoints->ppqStart;
+                loopEndPpq = loopPoints->ppqEnd;
+            }
+            else
+                isLooping = false;
+
+            if (auto hostPpq = position->getPpqPosition())
             {
-                lastBarPosition.store (*ppq / static_cast<double> (numerator));
+                ppq = *hostPpq;
                 gotInfo = true;
             }
+
+            // The host time stamps when this block reaches the output, which is
+            // what a performer hears; only trust it if it shares our clock.
+            if (auto hostTime = position->getHostTimeNs())
+            {
+                hostTimeNs = static_cast<double> (*hostTime);
+
+                if (std::abs (hostTimeNs - wallTimeNs) < 1.0e9)
+                    blockTimeNs = hostTimeNs;
+            }
         }
 #else
         juce::AudioPlayHead::CurrentPositionInfo info;
         if (playHead->getCurrentPosition (info))
         {
             isPlayingNow = info.isPlaying;
-            const int numerator = info.timeSigNumerator > 0 ? info.timeSigNumerator : 4;
+            isLooping = info.isLooping;
+            numerator = info.timeSigNumerator > 0 ? info.timeSigNumerator : 4;
+            bpm = info.bpm;
+            loopStartPpq = info.ppqLoopStart;
+            loopEndPpq = info.ppqLoopEnd;
 
             if (info.ppqPosition >= 0.0)
             {
-                lastBarPosition.store (info.ppqPosition / static_cast<double> (numerator));
+                ppq = info.ppqPosition;
                 gotInfo = true;
             }
         }
 #endif
     }
 
+    if (gotInfo)
+    {
+        lastBarPosition.store (ppq / static_cast<double> (numerator));
+        detectDiscontinuities (ppq, bpm, numerator, isPlayingNow, isLooping, loopStartPpq, numSamples);
+    }
+
+    const double sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+    blockTransport = { ppq, bpm, numerator, sampleRate, blockTimeNs, isPlayingNow, gotInfo };
+
+    {
+        const juce::SpinLock::ScopedTryLockType lock (transportSnapshotLock);
+        if (lock.isLocked())
+            transportSnapshot = blockTransport;
+    }
+
+    if (traceRecorder.isRecording())
+    {
+        using Record = TransportTraceRecorder::Record;
+
+        Record record;
+        record.wallTimeNs = wallTimeNs;
+        record.hostTimeNs = juce::jmax (0.0, hostTimeNs);
+        record.sampleRate = sampleRate;
+        record.ppq = ppq;
+        record.bpm = bpm;
+        record.loopStartPpq = loopStartPpq;
+        record.loopEndPpq = loopEndPpq;
+        record.numSamples = numSamples;
+        record.numerator = numerator;
+        record.flags = (gotInfo ? Record::hasPpq : 0)
+                     | (isPlayingNow ? Record::playing : 0)
+                     | (isLooping ? Record::looping : 0)
+                     | (hostTimeNs >= 0.0 ? Record::hasHostTime : 0)
+                     | (isNonRealtime() ? Record::nonRealtime : 0);
+
+        traceRecorder.push (record);
+    }
+
+    hadPpq = gotInfo;
     playheadValid.store (gotInfo);
     isPlaying.store (isPlayingNow);
+    oscRemote.publishTransport (lastBarPosition.load(), isPlayingNow);
 
     if (wasPlaying && ! isPlayingNow)
         stoppedFlag.store (true);
@@ -257,13 +913,132 @@ void RosettaPrompterAudioProcessor::updatePlayheadInfo()
     wasPlaying = isPlayingNow;
 }
 
+void RosettaPrompterAudioProcessor::detectDiscontinuities (double ppq, double bpm, int numerator, bool isPlayingNow,
+                                                           bool isLooping, double loopStartPpq, int numSamples)
+{
+    const auto toBars = [numerator] (double beats) { return beats / static_cast<double> (numerator); };
+
+    if (hadPpq)
+    {
+        const double sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+        const double advance = wasPlaying ? lastBpm / 60.0 * lastNumSamples / sampleRate : 0.0;
+        const double jump = ppq - (lastPpq + advance);
+
+        // Hosts report positions with some jitter; anything under half a beat is
+        // left to the view's smoothing.
+        constexpr double seekThresholdBeats = 0.5;
+
+        const bool landedAtLoopStart = ppq >= loopStartPpq - seekThresholdBeats
+                                    && ppq < loopStartPpq + advance + seekThresholdBeats;
+
+        if (isPlayingNow && isLooping && jump < -seekThresholdBeats && landedAtLoopStart)
+            pushTransportEvent ({ TransportEvent::Type::loopWrap, toBars (ppq), bpm });
+        else if (std::abs (jump) > seekThresholdBeats)
+            pushTransportEvent ({ TransportEvent::Type::seek, toBars (ppq), bpm });
+    }
+
+    lastPpq = ppq;
+    lastBpm = bpm;
+    lastNumSamples = numSamples;
+}
+
+void RosettaPrompterAudioProcessor::pushTransportEvent (const TransportEvent& event)
+{
+    const auto scope = transportEventFifo.write (1);
+    if (scope.blockSize1 > 0)
+        transportEvents[(size_t) scope.startIndex1] = event;
+}
+
+void RosettaPrompterAudioProcessor::captureMidiTaps (const juce::MidiBuffer& midiMessages)
+{
+    if (! timingRecording.load() || ! blockTransport.isValid || ! blockTransport.isPlaying)
+        return;
+
+    for (const auto metadata : midiMessages)
+    {
+        if (! metadata.getMessage().isNoteOn())
+            continue;
+
+        const auto scope = timingTapFifo.write (1);
+        if (scope.blockSize1 > 0)
+            timingTaps[(size_t) scope.startIndex1] = blockTransport.getBarAtSample (metadata.samplePosition);
+    }
+}
+
+void RosettaPrompterAudioProcessor::pushBounceBlock (int numSamples)
+{
+    // An offline render ends when the host stops the transport, leaves
+    // non-realtime mode or releases resources, whichever comes first. Blocks
+    // before playback starts leave the prepared session waiting.
+    if (! blockTransport.isPlaying)
+    {
+        if (bounceWriter.isActive())
+            bounceWriter.end();
+
+        return;
+    }
+
+    if (! bounceWriter.isActive())
+    {
+        if (! bounceWriter.begin (blockTransport.sampleRate))
+            return;
+
+        bounceSamplePosition = 0;
+    }
+
+    bounceWriter.pushBlock ({ bounceSamplePosition, blockTransport.ppq, blockTransport.bpm, blockTransport.numerator,
+                              numSamples, blockTransport.isPlaying, blockTransport.isValid });
+    bounceSamplePosition += numSamples;
+}
+
+void RosettaPrompterAudioProcessor::prepareBounce()
+{
+    // The lyrics and the timeline are copied here, off the audio thread, so the
+    // first offline block only switches the writer on.
+    const auto lyrics = getLyricsText();
+    if (lyrics.trim().isEmpty())
+        return;
+
+    BounceLyricsWriter::Session session;
+    session.lines = juce::StringArray::fromLines (lyrics);
+    session.timeline.setLines (session.lines);
+    session.timeline.setNumLines (session.lines.size());
+    syncTimeline (session.timeline);
+    session.outputFolder = getCacheFolder();
+    session.baseName = "bounce-" + juce::Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S")
+                       + "-" + juce::String (instanceNumber);
+
+    // If the previous bounce's files are still being written this render is
+    // skipped rather than stalling the host.
+    if (! bounceWriter.prepare (std::move (session)))
+        logMessage ("Lyric bounce skipped: the previous bounce is still being written");
+}
+
+double RosettaPrompterAudioProcessor::getTimeNs()
+{
+    return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks()) * 1.0e9;
+}
+
+double RosettaPrompterAudioProcessor::TransportSnapshot::getBarAtSample (int sampleOffset) const
+{
+    return (ppq + sampleOffset / sampleRate * bpm / 60.0) / static_cast<double> (numerator);
+}
+
+double RosettaPrompterAudioProcessor::TransportSnapshot::getBarAtTime (double nanoseconds) const
+{
+    return (ppq + (nanoseconds - timeNs) * 1.0e-9 * bpm / 60.0) / static_cast<double> (numerator);
+}
+
 void RosettaPrompterAudioProcessor::logMessage (const juce::String& message)
 {
-    auto logDir = juce::File::getSpecialLocation (juce::File::userHomeDirectory)
-        .getChildFile ("Library")
-        .getChildFile ("Logs");
-    logDir.createDirectory();
-    auto logFile = logDir.getChildFile ("RosettaPrompter.log");
+    static const auto logFile = []
+    {
+        auto logDir = juce::File::getSpecialLocation (juce::File::userHomeDirectory)
+            .getChildFile ("Library")
+            .getChildFile ("Logs");
+        logDir.createDirectory();
+        return logDir.getChildFile ("RosettaPrompter.log");
+    }();
 
     logFile.appendText (juce::Time::getCurrentTime().toString (true, true)
         + "  " + message + "\n");
@@ -271,8 +1046,14 @@ void RosettaPrompterAudioProcessor::logMessage (const juce::String& message)
 
 juce::File RosettaPrompterAudioProcessor::getCacheFolder()
 {
-    auto folder = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+    static const auto folder = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
         .getChildFile ("RosettaPrompterCache");
+    return folder;
+}
+
+juce::File RosettaPrompterAudioProcessor::createCacheFolder()
+{
+    auto folder = getCacheFolder();
     folder.createDirectory();
     return folder;
 }
@@ -1,8 +1,18 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
-
-class RosettaPrompterAudioProcessor : public juce::AudioProcessor
+#include <array>
+#include <map>
+#include <vector>
+#include "BounceLyricsWriter.h"
+#include "InputMeter.h"
+#include "OscRemote.h"
+#include "PrompterTimeline.h"
+#include "TransportTraceRecorder.h"
+
+class RosettaPrompterAudioProcessor : public juce::AudioProcessor,
+                                      private juce::Timer,
+                                      private juce::AsyncUpdater
 {
 public:
     struct ParamIDs
@@ -13,6 +23,29 @@ public:
         static constexpr const char* startBar = "StartBar";
         static constexpr const char* endBar = "EndBar";
         static constexpr const char* resetOnStop = "ResetOnStop";
+        static constexpr const char* timingMode = "TimingMode";
+    };
+
+    struct TransportEvent
+    {
+        enum class Type
+        {
+            loopWrap,
+            seek
+        };
+
+        Type type = Type::seek;
+        double barPosition = 0.0;
+        double bpm = 120.0;
+    };
+
+    // Where the prompter should be on a UI tick. positionJumped is set when the
+    // transport looped or seeked, so the view jumps instead of easing there.
+    struct ActivePosition
+    {
+        PrompterTimeline::Position position;
+        bool isValid = false;
+        bool positionJumped = false;
     };
 
     RosettaPrompterAudioProcessor();
@@ -20,6 +53,7 @@ public:
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void setNonRealtime (bool shouldBeNonRealtime) noexcept override;
 
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
@@ -48,30 +82,172 @@ public:
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
     float getParameterValue (const juce::String& paramID) const;
+    bool setParameterValue (const juce::String& paramID, float value);
+
+    const InputMeter& getInputMeter() const;
 
     bool isPlayheadValid() const;
+    bool isTransportPlaying() const;
     double getLastBarPosition() const;
     bool consumeStoppedFlag();
+    bool popTransportEvent (TransportEvent& event);
+
+    // The transport-to-line mapping shared by the editor, the bounce writer and
+    // the replay tool. syncTimeline applies the calibration, timing mode, line
+    // weights and tapped timing map; the caller owns the lines. followTransport
+    // picks the line for the current position: a remote cue while stopped, the
+    // last tapped line while recording timing, otherwise the playhead. It drains
+    // the transport events unless told not to. Message thread only.
+    void syncTimeline (PrompterTimeline& timeline) const;
+    ActivePosition followTransport (PrompterTimeline& timeline, bool consumeEvents = true);
+
+    void setRemoteCueLine (int line);
+    int getRemoteCueLine() const;
 
     bool setStartBarToCurrent();
     bool setEndBarToCurrent();
+    bool setStartBar (float bar);
+    bool setEndBar (float bar);
+
+    void setTimingRecording (bool shouldRecord);
+    bool isTimingRecording() const;
+    bool recordTimingTap();
+    int collectTimingTaps();
+    int getNextTimingLine() const;
+    std::vector<double> getTimingMap() const;
+    void clearTimingMap();
+    void setTimingMap (std::vector<double> startBars);
 
-    void setLyricsText (const juce::String& text);
-    juce::String getLyricsText() const;
+    static constexpr int maxLyricsColumns = 3;
+
+    void setLyricsText (const juce::String& text, int column = 0);
+    juce::String getLyricsText (int column = 0) const;
+
+    void setLyricsFile (const juce::File& file, int column = 0);
+    juce::File getLyricsFile (int column = 0) const;
+    bool loadLyricsFile (const juce::File& file, int column = 0);
+    int getLyricsRevision() const;
+
+    void setLineWeightOverride (int line, double weight);
+    void clearLineWeightOverride (int line);
+    std::map<int, double> getLineWeightOverrides() const;
+
+    void setNumLyricsColumns (int numColumns);
+    int getNumLyricsColumns() const;
+
+    // Returns false, and leaves the remote off, when the sockets can't be opened.
+    bool setOscEnabled (bool shouldBeEnabled);
+    bool isOscEnabled() const;
+    OscRemote& getOscRemote();
+
+    // Applies queued OSC commands and publishes the active line. Runs on the
+    // processor's timer while the remote is enabled, with or without an editor.
+    void updateRemoteControl();
+
+    void setTraceRecording (bool shouldRecord);
+    bool isTraceRecording() const;
+    juce::File getTraceFile() const;
 
     static void logMessage (const juce::String& message);
     static juce::File getCacheFolder();
+    static juce::File createCacheFolder();
 
 private:
-    void updatePlayheadInfo();
+    struct TransportSnapshot
+    {
+        double ppq = 0.0;
+        double bpm = 120.0;
+        int numerator = 4;
+        double sampleRate = 44100.0;
+        double timeNs = 0.0;
+        bool isPlaying = false;
+        bool isValid = false;
+
+        double getBarAtSample (int sampleOffset) const;
+        double getBarAtTime (double nanoseconds) const;
+    };
+
+    void updatePlayheadInfo (int numSamples);
+    void detectDiscontinuities (double ppq, double bpm, int numerator, bool isPlayingNow,
+                                bool isLooping, double loopStartPpq, int numSamples);
+    void pushTransportEvent (const TransportEvent& event);
+    void captureMidiTaps (const juce::MidiBuffer& midiMessages);
+    void addTimingTap (double bar);
+    void timerCallback() override;
+    void handleAsyncUpdate() override;
+    void handleRemoteCommands();
+    void updateRemoteLines();
+    void queueOscState (bool shouldBeEnabled, const OscRemote::Settings& settings);
+    void applyPendingOscState();
+    void pushBounceBlock (int numSamples);
+    void prepareBounce();
+    static double getTimeNs();
+    static juce::Identifier getLyricsPropertyID (int column);
+    static juce::Identifier getLyricsFilePropertyID (int column);
+
+    InputMeter inputMeter;
 
     std::atomic<double> lastBarPosition { 0.0 };
     std::atomic<bool> playheadValid { false };
     std::atomic<bool> isPlaying { false };
     std::atomic<bool> stoppedFlag { false };
 
+    static constexpr int transportEventCapacity = 32;
+    juce::AbstractFifo transportEventFifo { transportEventCapacity };
+    std::array<TransportEvent, transportEventCapacity> transportEvents;
+
     bool wasPlaying = false;
-    juce::String lyricsText;
+    bool hadPpq = false;
+    double lastPpq = 0.0;
+    double lastBpm = 0.0;
+    int lastNumSamples = 0;
+    int remoteCueLine = -1;
+
+    // blockTransport belongs to the audio thread; transportSnapshot is the copy
+    // UI taps interpolate from, published whenever the lock isn't contended.
+    TransportSnapshot blockTransport;
+    juce::SpinLock transportSnapshotLock;
+    TransportSnapshot transportSnapshot;
+
+    std::atomic<bool> timingRecording { false };
+    static constexpr int timingTapCapacity = 256;
+    juce::AbstractFifo timingTapFifo { timingTapCapacity };
+    std::array<double, timingTapCapacity> timingTaps {};
+    std::vector<double> timingMap;
+    int timingLineLimit = 0;
+
+    OscRemote oscRemote;
+    OscRemote::Settings oscSettings;
+    std::atomic<bool> oscEnabled { false };
+    bool oscRequested = false;
+
+    // The remote is only started and stopped on the message thread. State
+    // restored on other threads is parked here until the async update runs;
+    // the lock also covers oscSettings for getStateInformation.
+    juce::CriticalSection oscStateLock;
+    OscRemote::Settings pendingOscSettings;
+    bool pendingOscEnabled = false;
+    std::atomic<bool> oscStatePending { false };
+    PrompterTimeline remoteTimeline;
+    int remoteLyricsRevision = -1;
+    int remoteActiveLine = 0;
+    TransportTraceRecorder traceRecorder;
+
+    std::array<juce::String, maxLyricsColumns> lyricsColumns;
+    std::array<juce::String, maxLyricsColumns> lyricsFiles;
+    int numLyricsColumns = 1;
+    std::atomic<int> lyricsRevision { 0 };
+    std::map<int, double> lineWeightOverrides;
+    int timingDataRevision = 0;
+
+    // Guards the lyrics, their files and column count, the weights, the timing
+    // map, their revision and the tap line limit, shared by the message thread,
+    // the host's state calls and bounce setup.
+    juce::CriticalSection timingDataLock;
+
+    BounceLyricsWriter bounceWriter;
+    juce::int64 bounceSamplePosition = 0;
+    const int instanceNumber;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RosettaPrompterAudioProcessor)
 };
@@ -0,0 +1,121 @@
+#include "PrompterFrameRenderer.h"
+#include <cmath>
+
+PrompterFrameRenderer::Theme PrompterFrameRenderer::Theme::forDarkMode (bool useDarkTheme)
+{
+    if (useDarkTheme)
+        return { juce::Colour (0xff0f1115), juce::Colour (0xfff2f2f2), juce::Colour (0xff2f81f7), true };
+
+    return { juce::Colour (0xfff5e94b), juce::Colour (0xff1a1a1a), juce::Colour (0xfff58a1f), false };
+}
+
+PrompterFrameRenderer::Metrics PrompterFrameRenderer::Metrics::forFontSize (float fontSize)
+{
+    juce::Font font (fontSize);
+
+    Metrics metrics;
+    metrics.fontSize = fontSize;
+    metrics.lineSpacing = font.getHeight() * 0.35f;
+    metrics.lineHeight = static_cast<int> (std::ceil (font.getHeight() + metrics.lineSpacing));
+    metrics.padding = static_cast<int> (std::ceil (font.getHeight() * 0.6f));
+    return metrics;
+}
+
+PrompterFrameRenderer::PrompterFrameRenderer (const juce::StringArray& linesToRender, float fontSize, bool useDarkTheme)
+    : lines (linesToRender),
+      theme (Theme::forDarkMode (useDarkTheme)),
+      metrics (Metrics::forFontSize (fontSize)),
+      font (fontSize)
+{
+    if (lines.isEmpty())
+        lines.add ({});
+
+    layoutCache.setFont (font);
+    layoutCache.setLines (lines);
+    layoutCache.prepareAll();
+}
+
+int PrompterFrameRenderer::getNumLines() const
+{
+    return lines.size();
+}
+
+double PrompterFrameRenderer::getScrollForLine (double linePosition, int viewHeight) const
+{
+    const double contentHeight = lines.size() * metrics.lineHeight + metrics.padding * 2;
+    const double maxScroll = juce::jmax (0.0, contentHeight - viewHeight);
+    const double lineTop = metrics.padding + linePosition * metrics.lineHeight;
+    const double target = lineTop - (viewHeight * 0.5) + (metrics.lineHeight * 0.5);
+
+    return juce::jlimit (0.0, maxScroll, target);
+}
+
+double PrompterFrameRenderer::getSmoothedScroll (double currentY, double targetY)
+{
+    const double delta = (targetY - currentY) * 0.2;
+    return std::abs (delta) < 0.5 ? targetY : currentY + delta;
+}
+
+void PrompterFrameRenderer::renderFrame (juce::Graphics& g, int width, int height, PrompterTimeline::Position position) const
+{
+    g.fillAll (theme.background);
+
+    const int activeLine = juce::jlimit (0, lines.size() - 1, position.line);
+    const auto scrollY = static_cast<int> (std::round (getScrollForLine (activeLine + position.progress, height)));
+
+    juce::Graphics::ScopedSaveState state (g);
+    g.setOrigin (0, -scrollY);
+
+    const int textX = metrics.padding + metrics.textIndent;
+
+    paintLineHighlight (g, theme, metrics, activeLine, width);
+
+    if (layoutCache.getNumSegments (activeLine) > 0)
+        paintLineProgress (g, theme, metrics, activeLine, width,
+                           static_cast<float> (textX) + layoutCache.getProgressWidth (activeLine, position.progress));
+
+    g.reduceClipRegion (0, scrollY, width, height);
+    paintVisibleLines (g, theme, metrics, font, lines, textX, width);
+}
+
+void PrompterFrameRenderer::paintLineHighlight (juce::Graphics& g, const Theme& theme, const Metrics& metrics,
+                                                int lineIndex, int width)
+{
+    const float y = static_cast<float> (metrics.padding + lineIndex * metrics.lineHeight);
+
+    g.setColour (theme.highlight.withAlpha (theme.dark ? 0.25f : 0.2f));
+    g.fillRoundedRectangle (static_cast<float> (metrics.padding / 2), y,
+                            static_cast<float> (width - metrics.padding), static_cast<float> (metrics.lineHeight), 6.0f);
+}
+
+void PrompterFrameRenderer::paintVisibleLines (juce::Graphics& g, const Theme& theme, const Metrics& metrics,
+                                               const juce::Font& font, const juce::StringArray& lines, int textX, int width)
+{
+    const auto clip = g.getClipBounds();
+    const int firstVisible = juce::jmax (0, (clip.getY() - metrics.padding) / metrics.lineHeight);
+    const int lastVisible = juce::jmin (lines.size() - 1, (clip.getBottom() - metrics.padding) / metrics.lineHeight);
+    const int textWidth = juce::jmax (1, width - textX - metrics.padding);
+
+    g.setFont (font);
+    g.setColour (theme.text);
+
+    for (int i = firstVisible; i <= lastVisible; ++i)
+        g.drawText (lines[i], textX, metrics.padding + i * metrics.lineHeight, textWidth, metrics.lineHeight,
+                    juce::Justification::centredLeft, false);
+}
+
+void PrompterFrameRenderer::paintLineProgress (juce::Graphics& g, const Theme& theme, const Metrics& metrics,
+                                               int lineIndex, int width, float progressRight)
+{
+    const float left = static_cast<float> (metrics.padding / 2);
+    const float y = static_cast<float> (metrics.padding + lineIndex * metrics.lineHeight);
+
+    if (progressRight <= left)
+        return;
+
+    juce::Graphics::ScopedSaveState state (g);
+    g.reduceClipRegion (juce::Rectangle<float> (left, y, progressRight - left, static_cast<float> (metrics.lineHeight)).getSmallestIntegerContainer());
+
+    g.setColour (theme.highlight.withAlpha (theme.dark ? 0.45f : 0.4f));
+    g.fillRoundedRectangle (left, y, static_cast<float> (width - metrics.padding), static_cast<float> (metrics.lineHeight), 6.0f);
+}
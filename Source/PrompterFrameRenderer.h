@@ -0,0 +1,60 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "LineLayoutCache.h"
+#include "PrompterTimeline.h"
+
+class PrompterFrameRenderer
+{
+public:
+    struct Theme
+    {
+        juce::Colour background;
+        juce::Colour text;
+        juce::Colour highlight;
+        bool dark = true;
+
+        static Theme forDarkMode (bool useDarkTheme);
+    };
+
+    struct Metrics
+    {
+        float fontSize = 24.0f;
+        float lineSpacing = 0.0f;
+        int lineHeight = 24;
+        int padding = 12;
+        int textIndent = 4;
+
+        static Metrics forFontSize (float fontSize);
+    };
+
+    PrompterFrameRenderer (const juce::StringArray& lines, float fontSize, bool useDarkTheme);
+
+    int getNumLines() const;
+    double getScrollForLine (double linePosition, int viewHeight) const;
+
+    // One step of the live view's scroll easing, run at 60 Hz.
+    static double getSmoothedScroll (double currentY, double targetY);
+
+    // Draws one frame from the position alone, scrolling continuously with the
+    // line progress. The live view instead eases towards each line's centre;
+    // see the README.
+    void renderFrame (juce::Graphics& g, int width, int height, PrompterTimeline::Position position) const;
+
+    static void paintLineHighlight (juce::Graphics& g, const Theme& theme, const Metrics& metrics,
+                                    int lineIndex, int width);
+    static void paintLineProgress (juce::Graphics& g, const Theme& theme, const Metrics& metrics,
+                                   int lineIndex, int width, float progressRight);
+
+    // Draws only the lines inside the clip region, so the cost follows the
+    // visible area rather than the length of the text.
+    static void paintVisibleLines (juce::Graphics& g, const Theme& theme, const Metrics& metrics, const juce::Font& font,
+                                   const juce::StringArray& lines, int textX, int width);
+
+private:
+    juce::StringArray lines;
+    Theme theme;
+    Metrics metrics;
+    juce::Font font;
+    LineLayoutCache layoutCache;
+};
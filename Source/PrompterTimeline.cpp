@@ -0,0 +1,333 @@
+#include "PrompterTimeline.h"
+#include "LineDiff.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    bool isVowel (juce::juce_wchar c)
+    {
+        static const juce::String vowels (juce::CharPointer_UTF8 (
+            "aeiouy\xc3\xa0\xc3\xa1\xc3\xa2\xc3\xa3\xc3\xa4\xc3\xa5\xc3\xa6\xc3\xa8\xc3\xa9\xc3\xaa\xc3\xab"
+            "\xc3\xac\xc3\xad\xc3\xae\xc3\xaf\xc3\xb2\xc3\xb3\xc3\xb4\xc3\xb5\xc3\xb6\xc3\xb8\xc3\xb9\xc3\xba"
+            "\xc3\xbb\xc3\xbc\xc3\xbd\xc3\xbf\xc5\x93"
+            "\xd0\xb0\xd0\xb5\xd1\x91\xd0\xb8\xd0\xbe\xd1\x83\xd1\x8b\xd1\x8d\xd1\x8e\xd1\x8f"));
+
+        return vowels.containsChar (juce::CharacterFunctions::toLowerCase (c));
+    }
+
+    bool isSyllabicCharacter (juce::juce_wchar c)
+    {
+        // CJK and kana characters are roughly one sung syllable each.
+        return c >= 0x2e80 && c <= 0x9fff;
+    }
+}
+
+void PrompterTimeline::setNumLines (int newNumLines)
+{
+    numLines = juce::jmax (1, newNumLines);
+}
+
+int PrompterTimeline::getNumLines() const
+{
+    return numLines;
+}
+
+void PrompterTimeline::setCalibration (double newStartBar, double newEndBar)
+{
+    startBar = newStartBar;
+    endBar = newEndBar;
+}
+
+double PrompterTimeline::getStartBar() const
+{
+    return startBar;
+}
+
+double PrompterTimeline::getEndBar() const
+{
+    return endBar;
+}
+
+void PrompterTimeline::setMode (Mode newMode)
+{
+    mode = newMode;
+}
+
+PrompterTimeline::Mode PrompterTimeline::getMode() const
+{
+    return mode;
+}
+
+void PrompterTimeline::setLines (const juce::StringArray& newLines)
+{
+    const auto diff = LineDiff::compute (lines, newLines);
+    if (diff.isEmpty())
+        return;
+
+    lines = newLines;
+
+    if (diff.numRemovedLines == diff.insertedLines.size())
+    {
+        for (int i = 0; i < diff.numRemovedLines; ++i)
+        {
+            const int lineIndex = diff.firstLine + i;
+            const double oldWeight = getEffectiveWeight (lineIndex);
+
+            estimates[(size_t) lineIndex] = estimateSyllables (diff.insertedLines[i]);
+
+            const double delta = getEffectiveWeight (lineIndex) - oldWeight;
+            addToWeightTree (lineIndex, delta);
+            totalWeight += delta;
+        }
+
+        return;
+    }
+
+    // Lines were added or removed: splice the estimates so only the changed
+    // lines are re-counted, then rebuild the tree in linear time.
+    std::vector<double> inserted;
+    for (auto& line : diff.insertedLines)
+        inserted.push_back (estimateSyllables (line));
+
+    const auto first = estimates.begin() + diff.firstLine;
+    estimates.erase (first, first + diff.numRemovedLines);
+    estimates.insert (estimates.begin() + diff.firstLine, inserted.begin(), inserted.end());
+
+    rebuildWeightTree();
+}
+
+void PrompterTimeline::setWeightOverrides (std::map<int, double> newOverrides)
+{
+    if (newOverrides == weightOverrides)
+        return;
+
+    weightOverrides = std::move (newOverrides);
+    rebuildWeightTree();
+}
+
+double PrompterTimeline::getLineWeight (int lineIndex) const
+{
+    return getEffectiveWeight (lineIndex);
+}
+
+void PrompterTimeline::setLineStartBars (std::vector<double> newStartBars)
+{
+    lineStartBars = std::move (newStartBars);
+    std::sort (lineStartBars.begin(), lineStartBars.end());
+}
+
+void PrompterTimeline::clearLineStartBars()
+{
+    lineStartBars.clear();
+}
+
+bool PrompterTimeline::hasLineStartBars() const
+{
+    return ! lineStartBars.empty();
+}
+
+void PrompterTimeline::setSourceRevision (int newRevision)
+{
+    sourceRevision = newRevision;
+}
+
+int PrompterTimeline::getSourceRevision() const
+{
+    return sourceRevision;
+}
+
+PrompterTimeline::Position PrompterTimeline::getPositionAtBar (double bar) const
+{
+    if (hasLineStartBars())
+        return getMappedPosition (bar);
+
+    if (mode == Mode::weighted && totalWeight > 0.0)
+        return getWeightedPosition (bar);
+
+    return getLinearPosition (bar);
+}
+
+double PrompterTimeline::getCalibratedProgress (double bar) const
+{
+    double progress = 0.0;
+    if (endBar > startBar)
+        progress = (bar - startBar) / (endBar - startBar);
+
+    return juce::jlimit (0.0, 1.0, progress);
+}
+
+PrompterTimeline::Position PrompterTimeline::getLinearPosition (double bar) const
+{
+    const double progress = getCalibratedProgress (bar);
+
+    const int maxIndex = numLines - 1;
+    if (maxIndex == 0)
+        return { 0, progress };
+
+    const double scaled = progress * maxIndex;
+    const int line = juce::jmin (maxIndex, static_cast<int> (std::floor (scaled)));
+
+    return { line, scaled - line };
+}
+
+PrompterTimeline::Position PrompterTimeline::getWeightedPosition (double bar) const
+{
+    const double target = getCalibratedProgress (bar) * totalWeight;
+    const int line = juce::jmin (findLineForWeight (target), juce::jmin (numLines, static_cast<int> (estimates.size())) - 1);
+    const double weight = getEffectiveWeight (line);
+
+    double progress = 1.0;
+    if (weight > 0.0)
+        progress = juce::jlimit (0.0, 1.0, (target - getWeightBefore (line)) / weight);
+
+    return { line, progress };
+}
+
+PrompterTimeline::Position PrompterTimeline::getMappedPosition (double bar) const
+{
+    const auto numMapped = juce::jmin (static_cast<int> (lineStartBars.size()), numLines);
+    const auto first = lineStartBars.begin();
+    const auto last = first + numMapped;
+
+    const auto next = std::upper_bound (first, last, bar);
+    if (next == first)
+        return { 0, 0.0 };
+
+    const int line = static_cast<int> (next - first) - 1;
+    const double lineStart = lineStartBars[(size_t) line];
+    const double lineEnd = next != last ? *next : endBar;
+
+    double progress = 1.0;
+    if (lineEnd > lineStart)
+        progress = juce::jlimit (0.0, 1.0, (bar - lineStart) / (lineEnd - lineStart));
+
+    return { line, progress };
+}
+
+double PrompterTimeline::estimateSyllables (const juce::String& line)
+{
+    // Counts vowel groups per word, drops a silent trailing 'e', and gives
+    // every word at least one syllable. Blank lines weigh nothing, so stanza
+    // breaks are passed over rather than held.
+    int syllables = 0;
+    int wordSyllables = 0;
+    bool inWord = false;
+    bool previousWasVowel = false;
+    juce::juce_wchar previous = 0;
+    juce::juce_wchar beforePrevious = 0;
+
+    const auto finishWord = [&]
+    {
+        if (! inWord)
+            return;
+
+        if (wordSyllables > 1 && juce::CharacterFunctions::toLowerCase (previous) == 'e'
+            && ! isVowel (beforePrevious) && beforePrevious != 'l')
+            --wordSyllables;
+
+        syllables += juce::jmax (1, wordSyllables);
+        wordSyllables = 0;
+        inWord = false;
+        previousWasVowel = false;
+    };
+
+    for (auto t = line.getCharPointer(); ! t.isEmpty();)
+    {
+        const auto c = t.getAndAdvance();
+
+        if (isSyllabicCharacter (c))
+        {
+            finishWord();
+            ++syllables;
+        }
+        else if (juce::CharacterFunctions::isLetter (c))
+        {
+            const bool vowel = isVowel (c);
+            if (vowel && ! previousWasVowel)
+                ++wordSyllables;
+
+            inWord = true;
+            previousWasVowel = vowel;
+        }
+        else if (c != '\'')
+        {
+            finishWord();
+        }
+
+        beforePrevious = previous;
+        previous = c;
+    }
+
+    finishWord();
+    return static_cast<double> (syllables);
+}
+
+double PrompterTimeline::getEffectiveWeight (int lineIndex) const
+{
+    if (! juce::isPositiveAndBelow (lineIndex, static_cast<int> (estimates.size())))
+        return 0.0;
+
+    const auto found = weightOverrides.find (lineIndex);
+    if (found != weightOverrides.end())
+        return juce::jmax (0.0, found->second);
+
+    return estimates[(size_t) lineIndex];
+}
+
+void PrompterTimeline::rebuildWeightTree()
+{
+    const auto size = estimates.size();
+    weightTree.assign (size, 0.0);
+    totalWeight = 0.0;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        const double weight = getEffectiveWeight (static_cast<int> (i));
+        weightTree[i] += weight;
+        totalWeight += weight;
+
+        const auto parent = i | (i + 1);
+        if (parent < size)
+            weightTree[parent] += weightTree[i];
+    }
+}
+
+void PrompterTimeline::addToWeightTree (int lineIndex, double delta)
+{
+    for (auto i = static_cast<size_t> (lineIndex); i < weightTree.size(); i |= i + 1)
+        weightTree[i] += delta;
+}
+
+double PrompterTimeline::getWeightBefore (int lineIndex) const
+{
+    double sum = 0.0;
+    for (int i = lineIndex - 1; i >= 0; i = (i & (i + 1)) - 1)
+        sum += weightTree[(size_t) i];
+
+    return sum;
+}
+
+int PrompterTimeline::findLineForWeight (double target) const
+{
+    // Binary descent over the tree: the first line whose cumulative weight
+    // exceeds the target.
+    const auto size = weightTree.size();
+    size_t position = 0;
+    size_t step = 1;
+
+    while (step * 2 <= size)
+        step *= 2;
+
+    for (; step > 0; step /= 2)
+    {
+        const auto next = position + step;
+        if (next <= size && weightTree[next - 1] <= target)
+        {
+            position = next;
+            target -= weightTree[next - 1];
+        }
+    }
+
+    return static_cast<int> (position);
+}
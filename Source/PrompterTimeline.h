@@ -0,0 +1,75 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <map>
+#include <vector>
+
+class PrompterTimeline
+{
+public:
+    struct Position
+    {
+        int line = 0;
+        double progress = 0.0;
+    };
+
+    enum class Mode
+    {
+        linear,
+        weighted
+    };
+
+    void setNumLines (int newNumLines);
+    int getNumLines() const;
+
+    void setCalibration (double newStartBar, double newEndBar);
+    double getStartBar() const;
+    double getEndBar() const;
+
+    void setMode (Mode newMode);
+    Mode getMode() const;
+
+    void setLines (const juce::StringArray& newLines);
+    void setWeightOverrides (std::map<int, double> newOverrides);
+    double getLineWeight (int lineIndex) const;
+
+    void setLineStartBars (std::vector<double> newStartBars);
+    void clearLineStartBars();
+    bool hasLineStartBars() const;
+
+    // The revision of the weights and start bars last applied by the owner, so
+    // an owner syncing every frame can skip copying unchanged data.
+    void setSourceRevision (int newRevision);
+    int getSourceRevision() const;
+
+    Position getPositionAtBar (double bar) const;
+
+    static double estimateSyllables (const juce::String& line);
+
+private:
+    Position getLinearPosition (double bar) const;
+    Position getWeightedPosition (double bar) const;
+    Position getMappedPosition (double bar) const;
+    double getCalibratedProgress (double bar) const;
+
+    double getEffectiveWeight (int lineIndex) const;
+    void rebuildWeightTree();
+    void addToWeightTree (int lineIndex, double delta);
+    double getWeightBefore (int lineIndex) const;
+    int findLineForWeight (double target) const;
+
+    int numLines = 1;
+    double startBar = 0.0;
+    double endBar = 64.0;
+    Mode mode = Mode::linear;
+    std::vector<double> lineStartBars;
+    int sourceRevision = -1;
+
+    // Per-line syllable estimates, with a Fenwick tree over the effective
+    // weights so cumulative weight lookups and single-line updates are O(log n).
+    juce::StringArray lines;
+    std::vector<double> estimates;
+    std::map<int, double> weightOverrides;
+    std::vector<double> weightTree;
+    double totalWeight = 0.0;
+};
@@ -0,0 +1,68 @@
+#include "ScriptFileWatcher.h"
+
+ScriptFileWatcher::~ScriptFileWatcher()
+{
+    stopTimer();
+}
+
+void ScriptFileWatcher::watch (const juce::File& fileToWatch)
+{
+    file = fileToWatch;
+    lastModified = {};
+
+    // JUCE has no portable change notification, so poll the modification time;
+    // it is a single stat() call per tick.
+    startTimer (500);
+}
+
+void ScriptFileWatcher::stopWatching()
+{
+    stopTimer();
+    file = {};
+}
+
+juce::File ScriptFileWatcher::getFile() const
+{
+    return file;
+}
+
+void ScriptFileWatcher::timerCallback()
+{
+    if (diffInFlight || ! file.existsAsFile())
+        return;
+
+    const auto modificationTime = file.getLastModificationTime();
+    if (modificationTime != lastModified)
+        startDiff (modificationTime);
+}
+
+void ScriptFileWatcher::startDiff (juce::Time modificationTime)
+{
+    if (getDocument == nullptr || onFileChanged == nullptr)
+        return;
+
+    diffInFlight = true;
+
+    const auto document = getDocument();
+    const auto fileToRead = file;
+    juce::WeakReference<ScriptFileWatcher> weakThis (this);
+
+    juce::Thread::launch ([weakThis, document, fileToRead, modificationTime]
+    {
+        const auto diff = LineDiff::compute (juce::StringArray::fromLines (document.text),
+                                             juce::StringArray::fromLines (fileToRead.loadFileAsString()));
+
+        juce::MessageManager::callAsync ([weakThis, diff, revision = document.revision, modificationTime]
+        {
+            if (auto* watcher = weakThis.get())
+            {
+                watcher->diffInFlight = false;
+
+                // If the document was edited while the diff ran, leave lastModified
+                // alone so the next tick diffs against the new text.
+                if (diff.isEmpty() || watcher->onFileChanged (diff, revision))
+                    watcher->lastModified = modificationTime;
+            }
+        });
+    });
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <juce_events/juce_events.h>
+#include "LineDiff.h"
+#include <functional>
+
+class ScriptFileWatcher : private juce::Timer
+{
+public:
+    struct Document
+    {
+        juce::String text;
+        int revision = 0;
+    };
+
+    ScriptFileWatcher() = default;
+    ~ScriptFileWatcher() override;
+
+    void watch (const juce::File& fileToWatch);
+    void stopWatching();
+    juce::File getFile() const;
+
+    std::function<Document()> getDocument;
+    std::function<bool (const LineDiff&, int revision)> onFileChanged;
+
+private:
+    void timerCallback() override;
+    void startDiff (juce::Time modificationTime);
+
+    juce::File file;
+    juce::Time lastModified;
+    bool diffInFlight = false;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (ScriptFileWatcher)
+    JUCE_DECLARE_NON_COPYABLE (ScriptFileWatcher)
+};
@@ -3,63 +3,165 @@
 
 TeleprompterComponent::TeleprompterComponent()
 {
-    viewport.setViewedComponent (&content, false);
+    viewport.setViewedComponent (&columnHolder, false);
     viewport.setScrollBarsShown (false, false, false, false);
     addAndMakeVisible (viewport);
+    addAndMakeVisible (levelMeter);
+    levelMeter.setInterceptsMouseClicks (false, false);
 
-    content.onTextChanged = [this] (const juce::String& text)
-    {
-        updateContentHeight();
-        if (onTextChanged)
-            onTextChanged (text);
-    };
-
-    startTimerHz (60);
+    setNumColumns (1);
 }
 
 void TeleprompterComponent::setFontSize (float newSize)
 {
-    content.setFontSize (newSize);
+    fontSize = newSize;
+
+    for (auto* column : columns)
+        column->setFontSize (newSize);
+
     updateContentHeight();
 }
 
 void TeleprompterComponent::setTheme (bool useDarkTheme)
 {
-    content.setTheme (useDarkTheme);
+    darkTheme = useDarkTheme;
+
+    for (auto* column : columns)
+        column->setTheme (useDarkTheme);
+
+    levelMeter.setTheme (useDarkTheme);
 }
 
-void TeleprompterComponent::setActiveLine (int lineIndex)
+void TeleprompterComponent::setNumColumns (int newNumColumns)
 {
-    content.setActiveLine (lineIndex);
+    newNumColumns = juce::jlimit (1, maxColumns, newNumColumns);
+
+    while (columns.size() > newNumColumns)
+        columns.removeLast();
+
+    while (columns.size() < newNumColumns)
+    {
+        const int columnIndex = columns.size();
+        auto* column = columns.add (new ContentComponent());
+
+        column->setTheme (darkTheme);
+        column->setFontSize (fontSize);
+        column->setActiveLine (activeLine, activeProgress);
+        column->onTextChanged = [this, columnIndex] (const juce::String& text)
+        {
+            updateContentHeight();
+            if (onTextChanged)
+                onTextChanged (columnIndex, text);
+        };
+
+        columnHolder.addAndMakeVisible (column);
+    }
+
+    updateContentHeight();
+}
+
+int TeleprompterComponent::getNumColumns() const
+{
+    return columns.size();
+}
+
+void TeleprompterComponent::setActiveLine (int lineIndex, double lineProgress)
+{
+    activeLine = juce::jlimit (0, juce::jmax (0, getNumLines() - 1), lineIndex);
+    activeProgress = lineProgress;
+
+    for (auto* column : columns)
+        column->setActiveLine (activeLine, activeProgress);
 }
 
 int TeleprompterComponent::getActiveLine() const
 {
-    return content.getActiveLine();
+    return activeLine;
 }
 
 void TeleprompterComponent::setText (const juce::String& text)
 {
-    content.setText (text);
-    updateContentHeight();
+    setColumnText (0, text);
 }
 
 juce::String TeleprompterComponent::getText() const
 {
-    return content.getText();
+    return getColumnText (0);
+}
+
+void TeleprompterComponent::setColumnText (int columnIndex, const juce::String& text)
+{
+    if (auto* column = columns[columnIndex])
+    {
+        column->setText (text);
+        updateContentHeight();
+    }
+}
+
+juce::String TeleprompterComponent::getColumnText (int columnIndex) const
+{
+    if (auto* column = columns[columnIndex])
+        return column->getText();
+
+    return {};
+}
+
+bool TeleprompterComponent::applyLineDiff (int columnIndex, const LineDiff& diff, int expectedRevision)
+{
+    auto* column = columns[columnIndex];
+    if (column == nullptr || ! column->applyLineDiff (diff, expectedRevision))
+        return false;
+
+    updateContentHeight();
+
+    // Keep the reading position on the same text when lines were added or
+    // removed above it. The first column drives the timeline, so only its
+    // edits move the shared line index; other columns simply realign.
+    const int lineDelta = diff.insertedLines.size() - diff.numRemovedLines;
+    if (columnIndex == 0 && lineDelta != 0 && diff.firstLine + diff.numRemovedLines <= activeLine)
+    {
+        const int shift = lineDelta * column->getLineHeight();
+
+        targetScrollY += shift;
+        clampScrollTarget();
+        viewport.setViewPosition (0, juce::jlimit (0, getMaxScroll(), viewport.getViewPositionY() + shift));
+        setActiveLine (activeLine + lineDelta, activeProgress);
+    }
+
+    return true;
+}
+
+int TeleprompterComponent::getColumnRevision (int columnIndex) const
+{
+    if (auto* column = columns[columnIndex])
+        return column->getTextRevision();
+
+    return 0;
+}
+
+void TeleprompterComponent::beginEditing (int columnIndex)
+{
+    if (auto* column = columns[columnIndex])
+        column->beginEditing ({});
 }
 
 int TeleprompterComponent::getNumLines() const
 {
-    return content.getNumLines();
+    int numLines = 1;
+
+    for (auto* column : columns)
+        numLines = juce::jmax (numLines, column->getNumLines());
+
+    return numLines;
 }
 
 void TeleprompterComponent::setScrollTargetForLine (int lineIndex)
 {
+    const auto& primary = *columns.getFirst();
     const int clampedLine = juce::jlimit (0, juce::jmax (0, getNumLines() - 1), lineIndex);
-    const double lineTop = static_cast<double> (content.getPadding() + clampedLine * content.getLineHeight());
+    const double lineTop = static_cast<double> (primary.getPadding() + clampedLine * primary.getLineHeight());
     const double viewHeight = static_cast<double> (viewport.getHeight());
-    const double target = lineTop - (viewHeight * 0.5) + (content.getLineHeight() * 0.5);
+    const double target = lineTop - (viewHeight * 0.5) + (primary.getLineHeight() * 0.5);
 
     targetScrollY = juce::jlimit (0.0, static_cast<double> (getMaxScroll()), target);
 }
@@ -76,27 +178,82 @@ void TeleprompterComponent::scrollToTop()
     viewport.setViewPosition (0, 0);
 }
 
+void TeleprompterComponent::snapToScrollTarget()
+{
+    viewport.setViewPosition (0, static_cast<int> (std::round (targetScrollY)));
+}
+
+void TeleprompterComponent::setMeterLevels (float peakDb, float rmsDb, float loudnessLufs)
+{
+    levelMeter.setLevels (peakDb, rmsDb, loudnessLufs);
+}
+
 void TeleprompterComponent::resized()
 {
     viewport.setBounds (getLocalBounds());
     updateContentHeight();
 }
 
+void TeleprompterComponent::visibilityChanged()
+{
+    updateTimerState();
+}
+
+void TeleprompterComponent::parentHierarchyChanged()
+{
+    updateTimerState();
+}
+
+void TeleprompterComponent::updateTimerState()
+{
+    if (isVisible() && getPeer() != nullptr)
+    {
+        if (! isTimerRunning())
+            startTimerHz (60);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
 void TeleprompterComponent::timerCallback()
 {
     const auto currentY = static_cast<double> (viewport.getViewPositionY());
-    const double delta = (targetScrollY - currentY) * 0.2;
-    const double newY = std::abs (delta) < 0.5 ? targetScrollY : currentY + delta;
+    const double newY = PrompterFrameRenderer::getSmoothedScroll (currentY, targetScrollY);
 
     viewport.setViewPosition (0, static_cast<int> (std::round (newY)));
+    updateMeterBounds();
+}
+
+void TeleprompterComponent::updateMeterBounds()
+{
+    const auto& primary = *columns.getFirst();
+    const int lineHeight = primary.getLineHeight();
+    const int lineTop = primary.getPadding() + activeLine * lineHeight - viewport.getViewPositionY();
+    const int meterHeight = juce::jmax (8, lineHeight / 2);
+    const int meterWidth = 96;
+
+    levelMeter.setBounds (getWidth() - meterWidth - primary.getPadding(), lineTop + (lineHeight - meterHeight) / 2,
+                          meterWidth, meterHeight);
 }
 
 void TeleprompterComponent::updateContentHeight()
 {
+    const auto& primary = *columns.getFirst();
     const auto width = juce::jmax (1, viewport.getWidth());
-    const auto height = juce::jmax (viewport.getHeight(), content.getNumLines() * content.getLineHeight() + content.getPadding() * 2);
+    const auto height = juce::jmax (viewport.getHeight(), getNumLines() * primary.getLineHeight() + primary.getPadding() * 2);
+
+    columnHolder.setSize (width, height);
+
+    const int numColumns = columns.size();
+    for (int i = 0; i < numColumns; ++i)
+    {
+        const int left = width * i / numColumns;
+        const int right = width * (i + 1) / numColumns;
+        columns.getUnchecked (i)->setBounds (left, 0, right - left, height);
+    }
 
-    content.setSize (width, height);
     clampScrollTarget();
 }
 
@@ -107,14 +264,17 @@ void TeleprompterComponent::clampScrollTarget()
 
 int TeleprompterComponent::getMaxScroll() const
 {
-    return juce::jmax (0, content.getHeight() - viewport.getHeight());
+    return juce::jmax (0, columnHolder.getHeight() - viewport.getHeight());
 }
 
 TeleprompterComponent::ContentComponent::ContentComponent()
 {
-    addAndMakeVisible (editor);
+    addChildComponent (editor);
+    setMouseCursor (juce::MouseCursor::IBeamCursor);
 
-    editor.setMultiLine (false, true);
+    // Multi-line so inserted text keeps its '\n's (a single-line editor turns
+    // them into spaces); no word wrap, so each lyric line stays one row.
+    editor.setMultiLine (true, false);
     editor.setReturnKeyStartsNewLine (true);
     editor.setScrollbarsShown (false);
     editor.setCaretVisible (true);
@@ -126,6 +286,16 @@ TeleprompterComponent::ContentComponent::ContentComponent()
         handleTextChanged();
     };
 
+    editor.onEscapeKey = [this]
+    {
+        editor.giveAwayKeyboardFocus();
+    };
+
+    editor.onFocusLost = [this]
+    {
+        endEditing();
+    };
+
     setTheme (true);
     setFontSize (fontSize);
 }
@@ -140,35 +310,38 @@ void TeleprompterComponent::ContentComponent::setFontSize (float newSize)
 
 void TeleprompterComponent::ContentComponent::setTheme (bool useDarkTheme)
 {
-    darkTheme = useDarkTheme;
-
-    if (darkTheme)
-    {
-        backgroundColour = juce::Colour (0xff0f1115);
-        textColour = juce::Colour (0xfff2f2f2);
-        highlightColour = juce::Colour (0xff2f81f7);
-    }
-    else
-    {
-        backgroundColour = juce::Colour (0xfff5e94b);
-        textColour = juce::Colour (0xff1a1a1a);
-        highlightColour = juce::Colour (0xfff58a1f);
-    }
+    theme = PrompterFrameRenderer::Theme::forDarkMode (useDarkTheme);
 
     editor.setColour (juce::TextEditor::backgroundColourId, juce::Colours::transparentBlack);
-    editor.setColour (juce::TextEditor::textColourId, textColour);
-    editor.setColour (juce::TextEditor::highlightColourId, highlightColour.withAlpha (0.25f));
-    editor.setColour (juce::TextEditor::highlightedTextColourId, textColour);
-    editor.setColour (juce::TextEditor::outlineColourId, highlightColour.withAlpha (0.2f));
-    editor.setColour (juce::TextEditor::focusedOutlineColourId, highlightColour.withAlpha (0.5f));
+    editor.setColour (juce::TextEditor::textColourId, theme.text);
+    editor.setColour (juce::TextEditor::highlightColourId, theme.highlight.withAlpha (0.25f));
+    editor.setColour (juce::TextEditor::highlightedTextColourId, theme.text);
+    editor.setColour (juce::TextEditor::outlineColourId, theme.highlight.withAlpha (0.2f));
+    editor.setColour (juce::TextEditor::focusedOutlineColourId, theme.highlight.withAlpha (0.5f));
 
     repaint();
 }
 
-void TeleprompterComponent::ContentComponent::setActiveLine (int lineIndex)
+void TeleprompterComponent::ContentComponent::setActiveLine (int lineIndex, double lineProgress)
 {
-    activeLine = juce::jlimit (0, juce::jmax (0, numLines - 1), lineIndex);
-    repaint();
+    const int newLine = juce::jmax (0, lineIndex);
+
+    layoutCache.prepareLine (newLine);
+    const int newSegment = layoutCache.getSegmentIndex (newLine, lineProgress);
+    activeProgress = lineProgress;
+
+    if (newLine != activeLine)
+    {
+        repaintLine (activeLine);
+        repaintLine (newLine);
+    }
+    else if (newSegment != activeSegment)
+    {
+        repaintLine (newLine);
+    }
+
+    activeLine = newLine;
+    activeSegment = newSegment;
 }
 
 int TeleprompterComponent::ContentComponent::getActiveLine() const
@@ -178,13 +351,22 @@ int TeleprompterComponent::ContentComponent::getActiveLine() const
 
 void TeleprompterComponent::ContentComponent::setText (const juce::String& text)
 {
-    editor.setText (text, false);
-    handleTextChanged();
+    // Only '\n' is kept, so line counts and the character offsets used by
+    // applyLineDiff agree with StringArray::fromLines for CR and CRLF files.
+    const auto normalized = text.replace ("\r\n", "\n").replaceCharacter ('\r', '\n');
+
+    if (editing)
+        editor.setText (normalized, false);
+
+    setLines (juce::StringArray::fromLines (normalized));
 }
 
 juce::String TeleprompterComponent::ContentComponent::getText() const
 {
-    return editor.getText();
+    if (editing)
+        return editor.getText();
+
+    return layoutCache.getLines().joinIntoString ("\n");
 }
 
 int TeleprompterComponent::ContentComponent::getNumLines() const
@@ -194,61 +376,242 @@ int TeleprompterComponent::ContentComponent::getNumLines() const
 
 int TeleprompterComponent::ContentComponent::getLineHeight() const
 {
-    return lineHeight;
+    return metrics.lineHeight;
 }
 
 int TeleprompterComponent::ContentComponent::getPadding() const
 {
-    return padding;
+    return metrics.padding;
 }
 
 void TeleprompterComponent::ContentComponent::resized()
 {
+    const int padding = metrics.padding;
     editor.setBounds (padding, padding, juce::jmax (1, getWidth() - padding * 2), juce::jmax (1, getHeight() - padding * 2));
 }
 
 void TeleprompterComponent::ContentComponent::paint (juce::Graphics& g)
 {
-    g.fillAll (backgroundColour);
+    g.fillAll (theme.background);
+
+    PrompterFrameRenderer::paintLineHighlight (g, theme, metrics, activeLine, getWidth());
 
-    if (numLines > 0)
+    if (layoutCache.getNumSegments (activeLine) > 0)
+        PrompterFrameRenderer::paintLineProgress (g, theme, metrics, activeLine, getWidth(),
+            getTextLeft() + layoutCache.getProgressWidth (activeLine, activeProgress));
+
+    // While editing, the TextEditor draws the text on top instead.
+    if (! editing)
+        PrompterFrameRenderer::paintVisibleLines (g, theme, metrics, font, layoutCache.getLines(),
+                                                  juce::roundToInt (getTextLeft()), getWidth());
+}
+
+void TeleprompterComponent::ContentComponent::mouseDown (const juce::MouseEvent& event)
+{
+    beginEditing (event.getPosition());
+}
+
+void TeleprompterComponent::ContentComponent::beginEditing (juce::Point<int> position)
+{
+    if (editing)
+        return;
+
+    editor.setText (getText(), false);
+    editing = true;
+    editor.setVisible (true);
+    editor.grabKeyboardFocus();
+
+    const auto local = position - editor.getPosition();
+    editor.setCaretPosition (editor.getTextIndexAt (local.x, local.y));
+    repaint();
+}
+
+void TeleprompterComponent::ContentComponent::endEditing()
+{
+    if (! editing)
+        return;
+
+    // The lines already follow every edit, so the editor's copy of the text
+    // and its layout can go.
+    editing = false;
+    editor.setVisible (false);
+    editor.setText ({}, false);
+    repaint();
+}
+
+bool TeleprompterComponent::ContentComponent::applyLineDiff (const LineDiff& diff, int expectedRevision)
+{
+    if (expectedRevision != textRevision || diff.firstLine + diff.numRemovedLines > layoutCache.getNumLines())
+        return false;
+
+    if (editing)
+        spliceEditorText (diff);
+
+    layoutCache.replaceLines (diff.firstLine, diff.numRemovedLines, diff.insertedLines);
+    numLines = juce::jmax (1, layoutCache.getNumLines());
+    activeSegment = -1;
+    ++textRevision;
+    repaint();
+
+    if (onTextChanged)
+        onTextChanged (getText());
+
+    return true;
+}
+
+void TeleprompterComponent::ContentComponent::spliceEditorText (const LineDiff& diff)
+{
+    const auto text = editor.getText();
+    const int length = text.length();
+    const int numDocumentLines = layoutCache.getNumLines();
+    const int endLine = diff.firstLine + diff.numRemovedLines;
+
+    // Character offsets of the first changed line and of the line after the
+    // changed range; a line past the end starts one beyond the text.
+    int start = diff.firstLine == 0 ? 0 : -1;
+    int end = endLine == 0 ? 0 : -1;
+    int line = 0;
+    int index = 0;
+
+    for (auto t = text.getCharPointer(); ! t.isEmpty() && end < 0; ++index)
     {
-        const int clampedLine = juce::jlimit (0, numLines - 1, activeLine);
-        const float y = static_cast<float> (padding + clampedLine * lineHeight);
+        if (t.getAndAdvance() == '\n')
+        {
+            ++line;
+
+            if (line == diff.firstLine)
+                start = index + 1;
 
-        g.setColour (highlightColour.withAlpha (darkTheme ? 0.25f : 0.2f));
-        g.fillRoundedRectangle (static_cast<float> (padding / 2), y, static_cast<float> (getWidth() - padding), static_cast<float> (lineHeight), 6.0f);
+            if (line == endLine)
+                end = index + 1;
+        }
     }
+
+    if (start < 0)
+        start = length + 1;
+
+    auto replacement = diff.insertedLines.joinIntoString ("\n");
+
+    if (endLine < numDocumentLines)
+    {
+        if (! diff.insertedLines.isEmpty())
+            replacement << "\n";
+    }
+    else
+    {
+        end = length;
+
+        if (start > 0)
+        {
+            --start;
+
+            if (! diff.insertedLines.isEmpty())
+                replacement = "\n" + replacement;
+        }
+    }
+
+    const auto caret = editor.getCaretPosition();
+
+    // Detach the change callback so the editor does not queue a full re-scan;
+    // the lines are patched by applyLineDiff instead.
+    auto textChangeCallback = std::move (editor.onTextChange);
+    editor.onTextChange = nullptr;
+    editor.setHighlightedRegion ({ start, end });
+    editor.insertTextAtCaret (replacement);
+    editor.onTextChange = std::move (textChangeCallback);
+
+    const int shift = replacement.length() - (end - start);
+    editor.setCaretPosition (caret < start ? caret : (caret >= end ? caret + shift : start));
+}
+
+int TeleprompterComponent::ContentComponent::getTextRevision() const
+{
+    return textRevision;
 }
 
 void TeleprompterComponent::ContentComponent::handleTextChanged()
 {
-    numLines = countLines (editor.getText());
-    activeLine = juce::jlimit (0, juce::jmax (0, numLines - 1), activeLine);
+    setLines (juce::StringArray::fromLines (editor.getText()));
+}
+
+void TeleprompterComponent::ContentComponent::setLines (const juce::StringArray& newLines)
+{
+    layoutCache.setLines (newLines);
+    numLines = juce::jmax (1, newLines.size());
+    activeSegment = -1;
+    ++textRevision;
+    repaint();
 
     if (onTextChanged)
-        onTextChanged (editor.getText());
+        onTextChanged (getText());
 }
 
 void TeleprompterComponent::ContentComponent::updateMetrics()
 {
-    juce::Font font (fontSize);
+    metrics = PrompterFrameRenderer::Metrics::forFontSize (fontSize);
+
+    font = juce::Font (fontSize);
     editor.setFont (font);
-    editor.setLineSpacing (font.getHeight() * 0.35f);
+    editor.setLineSpacing (metrics.lineSpacing);
+    layoutCache.setFont (font);
+    activeSegment = -1;
+}
 
-    lineHeight = static_cast<int> (std::ceil (font.getHeight() + editor.getLineSpacing()));
-    padding = static_cast<int> (std::ceil (font.getHeight() * 0.6f));
+void TeleprompterComponent::ContentComponent::repaintLine (int lineIndex)
+{
+    repaint (0, metrics.padding + lineIndex * metrics.lineHeight, getWidth(), metrics.lineHeight);
+}
+
+float TeleprompterComponent::ContentComponent::getTextLeft() const
+{
+    return static_cast<float> (editor.getX() + editor.getBorder().getLeft() + editor.getLeftIndent());
+}
+
+void TeleprompterComponent::LevelMeter::setLevels (float newPeakDb, float newRmsDb, float newLoudnessLufs)
+{
+    const auto width = static_cast<float> (getWidth());
+    const auto moved = [width] (float oldDb, float newDb)
+    {
+        return std::abs (toProportion (oldDb) - toProportion (newDb)) * width >= 0.5f;
+    };
+
+    const bool changed = moved (peakDb, newPeakDb) || moved (rmsDb, newRmsDb) || moved (loudnessLufs, newLoudnessLufs);
+
+    peakDb = newPeakDb;
+    rmsDb = newRmsDb;
+    loudnessLufs = newLoudnessLufs;
+
+    if (changed)
+        repaint();
+}
+
+void TeleprompterComponent::LevelMeter::setTheme (bool useDarkTheme)
+{
+    theme = PrompterFrameRenderer::Theme::forDarkMode (useDarkTheme);
+    repaint();
 }
 
-int TeleprompterComponent::ContentComponent::countLines (const juce::String& text)
+void TeleprompterComponent::LevelMeter::paint (juce::Graphics& g)
 {
-    if (text.isEmpty())
-        return 1;
+    auto bounds = getLocalBounds().toFloat();
+
+    g.setColour (theme.text.withAlpha (0.12f));
+    g.fillRoundedRectangle (bounds, 3.0f);
 
-    int lines = 1;
-    for (auto character : text)
-        if (character == '\n')
-            ++lines;
+    auto levelBar = bounds.removeFromTop (bounds.getHeight() * 0.5f).reduced (1.0f);
+    auto loudnessBar = bounds.reduced (1.0f);
 
-    return lines;
+    g.setColour (theme.highlight);
+    g.fillRect (levelBar.withWidth (levelBar.getWidth() * toProportion (rmsDb)));
+
+    g.setColour (theme.text);
+    g.fillRect (levelBar.getX() + levelBar.getWidth() * toProportion (peakDb) - 1.0f, levelBar.getY(), 2.0f, levelBar.getHeight());
+
+    g.setColour (theme.highlight.withAlpha (0.6f));
+    g.fillRect (loudnessBar.withWidth (loudnessBar.getWidth() * toProportion (loudnessLufs)));
+}
+
+float TeleprompterComponent::LevelMeter::toProportion (float decibels)
+{
+    return juce::jlimit (0.0f, 1.0f, (decibels + 60.0f) / 60.0f);
 }
@@ -2,32 +2,56 @@
 
 #include <juce_gui_extra/juce_gui_extra.h>
 #include <functional>
+#include "LineDiff.h"
+#include "LineLayoutCache.h"
+#include "PrompterFrameRenderer.h"
 
 class TeleprompterComponent : public juce::Component, private juce::Timer
 {
 public:
+    static constexpr int maxColumns = 3;
+
     TeleprompterComponent();
 
     void setFontSize (float newSize);
     void setTheme (bool useDarkTheme);
 
-    void setActiveLine (int lineIndex);
+    void setActiveLine (int lineIndex, double lineProgress = 0.0);
     int getActiveLine() const;
 
+    void setNumColumns (int newNumColumns);
+    int getNumColumns() const;
+
     void setText (const juce::String& text);
     juce::String getText() const;
 
+    void setColumnText (int columnIndex, const juce::String& text);
+    juce::String getColumnText (int columnIndex) const;
+
+    bool applyLineDiff (int columnIndex, const LineDiff& diff, int expectedRevision);
+    int getColumnRevision (int columnIndex) const;
+
+    void beginEditing (int columnIndex);
+
     int getNumLines() const;
 
     void setScrollTargetForLine (int lineIndex);
     void setScrollTargetNormalized (double proportion);
     void scrollToTop();
+    void snapToScrollTarget();
 
-    std::function<void(const juce::String&)> onTextChanged;
+    void setMeterLevels (float peakDb, float rmsDb, float loudnessLufs);
+
+    std::function<void(int, const juce::String&)> onTextChanged;
 
     void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
 
 private:
+    // Each column keeps its text as lines and paints only those inside the
+    // clip region. A column only holds a TextEditor's copy of its text while
+    // it is being edited.
     class ContentComponent : public juce::Component
     {
     public:
@@ -35,47 +59,84 @@ private:
 
         void setFontSize (float newSize);
         void setTheme (bool useDarkTheme);
-        void setActiveLine (int lineIndex);
+        void setActiveLine (int lineIndex, double lineProgress);
         int getActiveLine() const;
 
         void setText (const juce::String& text);
         juce::String getText() const;
 
+        bool applyLineDiff (const LineDiff& diff, int expectedRevision);
+        int getTextRevision() const;
+
+        void beginEditing (juce::Point<int> position);
+        void endEditing();
+
         int getNumLines() const;
         int getLineHeight() const;
         int getPadding() const;
 
         void resized() override;
         void paint (juce::Graphics& g) override;
+        void mouseDown (const juce::MouseEvent& event) override;
 
         std::function<void(const juce::String&)> onTextChanged;
 
     private:
         void handleTextChanged();
+        void setLines (const juce::StringArray& newLines);
+        void spliceEditorText (const LineDiff& diff);
         void updateMetrics();
-        static int countLines (const juce::String& text);
+        void repaintLine (int lineIndex);
+        float getTextLeft() const;
 
         juce::TextEditor editor;
+        LineLayoutCache layoutCache;
+        juce::Font font { 24.0f };
+        bool editing = false;
         int activeLine = 0;
+        int activeSegment = -1;
+        int textRevision = 0;
+        double activeProgress = 0.0;
         int numLines = 1;
-        int lineHeight = 24;
-        int padding = 12;
         float fontSize = 24.0f;
-        bool darkTheme = true;
 
-        juce::Colour backgroundColour;
-        juce::Colour textColour;
-        juce::Colour highlightColour;
+        PrompterFrameRenderer::Theme theme;
+        PrompterFrameRenderer::Metrics metrics;
+    };
+
+    class LevelMeter : public juce::Component
+    {
+    public:
+        void setLevels (float newPeakDb, float newRmsDb, float newLoudnessLufs);
+        void setTheme (bool useDarkTheme);
+
+        void paint (juce::Graphics& g) override;
+
+    private:
+        static float toProportion (float decibels);
+
+        float peakDb = -100.0f;
+        float rmsDb = -100.0f;
+        float loudnessLufs = -100.0f;
+        PrompterFrameRenderer::Theme theme;
     };
 
     void timerCallback() override;
+    void updateTimerState();
+    void updateMeterBounds();
     void updateContentHeight();
     void clampScrollTarget();
     int getMaxScroll() const;
 
     juce::Viewport viewport;
-    ContentComponent content;
-
+    juce::Component columnHolder;
+    juce::OwnedArray<ContentComponent> columns;
+    LevelMeter levelMeter;
+
+    float fontSize = 24.0f;
+    bool darkTheme = true;
+    int activeLine = 0;
+    double activeProgress = 0.0;
     double targetScrollY = 0.0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TeleprompterComponent)
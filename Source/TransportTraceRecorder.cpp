@@ -0,0 +1,163 @@
+#include "TransportTraceRecorder.h"
+#include <cstring>
+
+namespace
+{
+    constexpr char magic[] = { 'R', 'P', 'T', 'R' };
+    constexpr juce::int64 recordBytes = 7 * sizeof (double) + 3 * sizeof (juce::int32);
+
+    void writeRecord (juce::OutputStream& out, const TransportTraceRecorder::Record& record)
+    {
+        out.writeDouble (record.wallTimeNs);
+        out.writeDouble (record.hostTimeNs);
+        out.writeDouble (record.sampleRate);
+        out.writeDouble (record.ppq);
+        out.writeDouble (record.bpm);
+        out.writeDouble (record.loopStartPpq);
+        out.writeDouble (record.loopEndPpq);
+        out.writeInt (record.numSamples);
+        out.writeInt (record.numerator);
+        out.writeInt (record.flags);
+    }
+
+    TransportTraceRecorder::Record readRecord (juce::InputStream& in)
+    {
+        TransportTraceRecorder::Record record;
+        record.wallTimeNs = in.readDouble();
+        record.hostTimeNs = in.readDouble();
+        record.sampleRate = in.readDouble();
+        record.ppq = in.readDouble();
+        record.bpm = in.readDouble();
+        record.loopStartPpq = in.readDouble();
+        record.loopEndPpq = in.readDouble();
+        record.numSamples = in.readInt();
+        record.numerator = in.readInt();
+        record.flags = in.readInt();
+        return record;
+    }
+}
+
+TransportTraceRecorder::TransportTraceRecorder()
+    : juce::Thread ("Transport Trace Writer")
+{
+}
+
+TransportTraceRecorder::~TransportTraceRecorder()
+{
+    stop();
+}
+
+bool TransportTraceRecorder::start (const juce::File& traceFile)
+{
+    stop();
+
+    auto newStream = std::make_unique<juce::FileOutputStream> (traceFile);
+    if (! newStream->openedOk() || ! newStream->setPosition (0) || ! newStream->truncate().wasOk())
+        return false;
+
+    newStream->write (magic, sizeof (magic));
+    newStream->writeInt (formatVersion);
+
+    // Allocated on first use and kept, so a push racing a stop never sees it freed.
+    if (records.empty())
+        records.resize ((size_t) capacity);
+
+    droppedRecords.store (0);
+    stream = std::move (newStream);
+    file = traceFile;
+
+    recording.store (true);
+    startThread();
+    return true;
+}
+
+void TransportTraceRecorder::stop()
+{
+    if (! recording.exchange (false))
+        return;
+
+    // A push that saw recording still set may be writing into the FIFO; once
+    // it finishes the audio thread can't touch it until the next start.
+    while (activePushes.load() > 0)
+        juce::Thread::yield();
+
+    stopThread (2000);
+    writePendingRecords();
+    fifo.reset();
+
+    stream->flush();
+    stream.reset();
+}
+
+bool TransportTraceRecorder::isRecording() const
+{
+    return recording.load();
+}
+
+juce::File TransportTraceRecorder::getFile() const
+{
+    return file;
+}
+
+int TransportTraceRecorder::getNumDroppedRecords() const
+{
+    return droppedRecords.load();
+}
+
+void TransportTraceRecorder::push (const Record& record)
+{
+    activePushes.fetch_add (1);
+
+    if (recording.load())
+    {
+        const auto scope = fifo.write (1);
+        if (scope.blockSize1 > 0)
+            records[(size_t) scope.startIndex1] = record;
+        else
+            droppedRecords.fetch_add (1);
+    }
+
+    activePushes.fetch_sub (1);
+}
+
+void TransportTraceRecorder::run()
+{
+    while (! threadShouldExit())
+    {
+        writePendingRecords();
+        wait (50);
+    }
+}
+
+void TransportTraceRecorder::writePendingRecords()
+{
+    const auto scope = fifo.read (fifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        writeRecord (*stream, records[(size_t) (scope.startIndex1 + i)]);
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        writeRecord (*stream, records[(size_t) (scope.startIndex2 + i)]);
+}
+
+bool TransportTraceRecorder::readFile (const juce::File& traceFile, std::vector<Record>& recordsOut)
+{
+    juce::FileInputStream in (traceFile);
+    if (! in.openedOk())
+        return false;
+
+    char header[sizeof (magic)] = {};
+    if (in.read (header, sizeof (header)) != (int) sizeof (header)
+        || std::memcmp (header, magic, sizeof (magic)) != 0
+        || in.readInt() != formatVersion)
+        return false;
+
+    recordsOut.clear();
+    recordsOut.reserve ((size_t) (in.getNumBytesRemaining() / recordBytes));
+
+    // A trace cut short by a crash ends mid-record; keep everything before it.
+    while (in.getNumBytesRemaining() >= recordBytes)
+        recordsOut.push_back (readRecord (in));
+
+    return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <vector>
+
+class TransportTraceRecorder : private juce::Thread
+{
+public:
+    // One entry per processBlock() call. Files start with "RPTR" and a format
+    // version, followed by little-endian records in field order.
+    struct Record
+    {
+        enum Flags
+        {
+            hasPpq = 1 << 0,
+            playing = 1 << 1,
+            looping = 1 << 2,
+            hasHostTime = 1 << 3,
+            nonRealtime = 1 << 4
+        };
+
+        double wallTimeNs = 0.0;
+        double hostTimeNs = 0.0;
+        double sampleRate = 44100.0;
+        double ppq = 0.0;
+        double bpm = 120.0;
+        double loopStartPpq = 0.0;
+        double loopEndPpq = 0.0;
+        int numSamples = 0;
+        int numerator = 4;
+        int flags = 0;
+
+        bool hasFlag (Flags flag) const { return (flags & flag) != 0; }
+    };
+
+    static constexpr const char* fileExtension = ".rptr";
+    static constexpr int formatVersion = 1;
+
+    TransportTraceRecorder();
+    ~TransportTraceRecorder() override;
+
+    bool start (const juce::File& traceFile);
+    void stop();
+    bool isRecording() const;
+    juce::File getFile() const;
+    int getNumDroppedRecords() const;
+
+    // Audio thread: copies the record into a preallocated FIFO, never blocks.
+    void push (const Record& record);
+
+    static bool readFile (const juce::File& traceFile, std::vector<Record>& records);
+
+private:
+    void run() override;
+    void writePendingRecords();
+
+    static constexpr int capacity = 16384;
+
+    juce::AbstractFifo fifo { capacity };
+    std::vector<Record> records;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    juce::File file;
+    std::atomic<bool> recording { false };
+    std::atomic<int> activePushes { 0 };
+    std::atomic<int> droppedRecords { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (TransportTraceRecorder)
+};
@@ -0,0 +1,98 @@
+#include "BounceLyricsWriter.h"
+
+class BounceLyricsWriterTests : public juce::UnitTest
+{
+public:
+    BounceLyricsWriterTests() : juce::UnitTest ("BounceLyricsWriter", "RosettaPrompter") {}
+
+    void runTest() override
+    {
+        beginTest ("LRC times floor to centiseconds and SRT times round to milliseconds");
+        {
+            expectTimes (612390, "[01:01.23]", "00:01:01,239");
+            expectTimes (599996, "[00:59.99]", "00:01:00,000");
+            expectTimes (35999999, "[59:59.99]", "01:00:00,000");
+            expectTimes (37234567, "[62:03.45]", "01:02:03,457");
+        }
+
+        beginTest ("SRT skips empty lines");
+        {
+            const juce::StringArray lines { "first", "  ", "third" };
+            const std::vector<BounceLyricsWriter::Transition> transitions { { 0, 0 }, { 1000, 1 }, { 2000, 2 } };
+
+            expectEquals (BounceLyricsWriter::createSrt (lines, transitions, 3000, 1000.0),
+                          juce::String ("1\n00:00:00,000 --> 00:00:01,000\nfirst\n\n"
+                                        "2\n00:00:02,000 --> 00:00:03,000\nthird\n\n"));
+        }
+
+        // At 240 bpm in 4/4 and 1024 Hz, one sample is exactly 1/1024 of a bar.
+        BounceLyricsWriter::Block block;
+        block.samplePosition = 2048;
+        block.ppq = 3.0;
+        block.bpm = 240.0;
+        block.numerator = 4;
+        block.numSamples = 1024;
+        block.isPlaying = true;
+        block.isValid = true;
+
+        beginTest ("A line change inside a block lands on the first sample showing it");
+        {
+            // One line per bar, starting at bar 0.1.
+            PrompterTimeline timeline;
+            timeline.setNumLines (5);
+            timeline.setCalibration (0.1, 4.1);
+
+            int currentLine = -1;
+            std::vector<BounceLyricsWriter::Transition> transitions;
+
+            // Bars 0.75 to 1.75: bar 1.1 falls between samples 358 and 359.
+            BounceLyricsWriter::findTransitions (timeline, 1024.0, block, currentLine, transitions);
+            expectEquals ((int) transitions.size(), 2);
+            expectTransition (transitions[0], 2048, 0);
+            expectTransition (transitions[1], 2048 + 359, 1);
+            expectEquals (currentLine, 1);
+
+            // The next block carries the line on without repeating it.
+            auto next = block;
+            next.samplePosition += block.numSamples;
+            next.ppq += 4.0;
+
+            BounceLyricsWriter::findTransitions (timeline, 1024.0, next, currentLine, transitions);
+            expectEquals ((int) transitions.size(), 3);
+            expectTransition (transitions[2], 2048 + 1024 + 359, 2);
+        }
+
+        beginTest ("A line change exactly on a sample belongs to that sample");
+        {
+            PrompterTimeline timeline;
+            timeline.setNumLines (5);
+            timeline.setCalibration (0.0, 4.0);
+
+            int currentLine = 0;
+            std::vector<BounceLyricsWriter::Transition> transitions;
+
+            BounceLyricsWriter::findTransitions (timeline, 1024.0, block, currentLine, transitions);
+            expectEquals ((int) transitions.size(), 1);
+            expectTransition (transitions[0], 2048 + 256, 1);
+        }
+    }
+
+private:
+    void expectTimes (juce::int64 sample, const juce::String& lrcTime, const juce::String& srtTime)
+    {
+        const juce::StringArray lines { "line" };
+        const std::vector<BounceLyricsWriter::Transition> transitions { { sample, 0 } };
+
+        expectEquals (BounceLyricsWriter::createLrc (lines, transitions, 10000.0), lrcTime + "line\n");
+        expectEquals (BounceLyricsWriter::createSrt (lines, transitions, sample, 10000.0),
+                      "1\n" + srtTime + " --> " + srtTime + "\nline\n\n");
+    }
+
+    void expectTransition (const BounceLyricsWriter::Transition& transition, juce::int64 sample, int line)
+    {
+        expectEquals (transition.sample, sample);
+        expectEquals (transition.line, line);
+    }
+};
+
+static BounceLyricsWriterTests bounceLyricsWriterTests;
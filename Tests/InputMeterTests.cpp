@@ -0,0 +1,63 @@
+#include "InputMeter.h"
+
+class InputMeterTests : public juce::UnitTest
+{
+public:
+    InputMeterTests() : juce::UnitTest ("InputMeter", "RosettaPrompter") {}
+
+    void runTest() override
+    {
+        beginTest ("Short-term loudness does not depend on the host buffer size");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int totalSamples = 8192 * 20;
+
+            juce::AudioBuffer<float> signal (2, totalSamples);
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < totalSamples; ++i)
+                    signal.setSample (channel, i, 0.5f * std::sin (juce::MathConstants<float>::twoPi * 1000.0f * (float) i / (float) sampleRate));
+
+            const auto largeBuffers = measure (signal, sampleRate, 8192);
+            const auto smallBuffers = measure (signal, sampleRate, 64);
+
+            expectWithinAbsoluteError (largeBuffers, smallBuffers, 0.05f);
+            expectGreaterThan (largeBuffers, -20.0f);
+        }
+
+        beginTest ("A single buffer longer than the loudness window");
+        {
+            constexpr double sampleRate = 48000.0;
+            constexpr int totalSamples = 48000 * 4;
+
+            juce::AudioBuffer<float> signal (1, totalSamples);
+            for (int i = 0; i < totalSamples; ++i)
+                signal.setSample (0, i, 0.25f * std::sin (juce::MathConstants<float>::twoPi * 1000.0f * (float) i / (float) sampleRate));
+
+            expectWithinAbsoluteError (measure (signal, sampleRate, totalSamples), measure (signal, sampleRate, 128), 0.05f);
+        }
+    }
+
+private:
+    static float measure (const juce::AudioBuffer<float>& signal, double sampleRate, int blockSize)
+    {
+        InputMeter meter;
+        meter.prepare (sampleRate, blockSize, signal.getNumChannels());
+
+        juce::AudioBuffer<float> block (signal.getNumChannels(), blockSize);
+
+        for (int start = 0; start < signal.getNumSamples(); start += blockSize)
+        {
+            const int numSamples = juce::jmin (blockSize, signal.getNumSamples() - start);
+            block.setSize (signal.getNumChannels(), numSamples, false, false, true);
+
+            for (int channel = 0; channel < signal.getNumChannels(); ++channel)
+                block.copyFrom (channel, 0, signal, channel, start, numSamples);
+
+            meter.process (block, signal.getNumChannels());
+        }
+
+        return meter.getSnapshot().shortTermLufs;
+    }
+};
+
+static InputMeterTests inputMeterTests;
@@ -0,0 +1,99 @@
+#include "PluginProcessor.h"
+#include "LineDiff.h"
+
+class LineWeightTests : public juce::UnitTest
+{
+public:
+    LineWeightTests() : juce::UnitTest ("LineWeights", "RosettaPrompter") {}
+
+    void runTest() override
+    {
+        beginTest ("Line mapping through a diff");
+        {
+            const auto diff = LineDiff::compute (juce::StringArray { "a", "b", "c", "d" },
+                                                 juce::StringArray { "a", "new", "b", "c", "d" });
+
+            expectEquals (diff.mapLine (0), 0);
+            expectEquals (diff.mapLine (1), 2);
+            expectEquals (diff.mapLine (3), 4);
+
+            const auto removal = LineDiff::compute (juce::StringArray { "a", "b", "c", "d" },
+                                                    juce::StringArray { "a", "d" });
+
+            expectEquals (removal.mapLine (1), -1);
+            expectEquals (removal.mapLine (2), -1);
+            expectEquals (removal.mapLine (3), 1);
+        }
+
+        beginTest ("A weight follows its line when a line is inserted above it");
+        {
+            RosettaPrompterAudioProcessor processor;
+            processor.setLyricsText ("one\ntwo\nthree\nfour");
+            processor.setLineWeightOverride (0, 0.5);
+            processor.setLineWeightOverride (2, 4.0);
+
+            processor.setLyricsText ("one\ninserted\ntwo\nthree\nfour");
+
+            const std::map<int, double> expected { { 0, 0.5 }, { 3, 4.0 } };
+            expect (processor.getLineWeightOverrides() == expected);
+        }
+
+        beginTest ("A weight is dropped with its line and edits in place keep it");
+        {
+            RosettaPrompterAudioProcessor processor;
+            processor.setLyricsText ("one\ntwo\nthree\nfour");
+            processor.setLineWeightOverride (1, 2.0);
+            processor.setLineWeightOverride (3, 3.0);
+
+            processor.setLyricsText ("one\nthree\nfour");
+            expect (processor.getLineWeightOverrides() == std::map<int, double> { { 2, 3.0 } });
+
+            processor.setLyricsText ("one\nthree\nfour, reworded");
+            expect (processor.getLineWeightOverrides() == std::map<int, double> { { 2, 3.0 } });
+        }
+
+        beginTest ("Translation columns do not move the weights");
+        {
+            RosettaPrompterAudioProcessor processor;
+            processor.setLyricsText ("one\ntwo");
+            processor.setLineWeightOverride (1, 2.0);
+
+            processor.setLyricsText ("uno\nextra\ndos", 1);
+            expect (processor.getLineWeightOverrides() == std::map<int, double> { { 1, 2.0 } });
+        }
+
+        beginTest ("A synced timeline follows weight, map and mode changes");
+        {
+            RosettaPrompterAudioProcessor processor;
+            processor.setLyricsText ("one\ntwo\nthree");
+
+            PrompterTimeline timeline;
+            timeline.setLines (juce::StringArray::fromLines (processor.getLyricsText()));
+            timeline.setNumLines (3);
+
+            processor.syncTimeline (timeline);
+            const int revision = timeline.getSourceRevision();
+            processor.syncTimeline (timeline);
+            expectEquals (timeline.getSourceRevision(), revision);
+
+            processor.setLineWeightOverride (1, 3.0);
+            processor.syncTimeline (timeline);
+            expectEquals (timeline.getLineWeight (1), 3.0);
+            expect (timeline.getSourceRevision() != revision);
+
+            processor.setTimingMap ({ 0.0, 2.0, 4.0 });
+            processor.syncTimeline (timeline);
+            expect (! timeline.hasLineStartBars());
+
+            processor.setParameterValue (RosettaPrompterAudioProcessor::ParamIDs::timingMode, 2.0f);
+            processor.syncTimeline (timeline);
+            expect (timeline.hasLineStartBars());
+
+            processor.setParameterValue (RosettaPrompterAudioProcessor::ParamIDs::timingMode, 0.0f);
+            processor.syncTimeline (timeline);
+            expect (! timeline.hasLineStartBars());
+        }
+    }
+};
+
+static LineWeightTests lineWeightTests;
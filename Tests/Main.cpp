@@ -0,0 +1,23 @@
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure (false);
+
+    if (args.containsOption ("--category"))
+        runner.runTestsInCategory (args.getValueForOption ("--category"));
+    else
+        runner.runAllTests();
+
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        if (auto* result = runner.getResult (i))
+            failures += result->failures;
+
+    return failures > 0 ? 1 : 0;
+}
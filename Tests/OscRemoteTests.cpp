@@ -0,0 +1,121 @@
+#include "PluginProcessor.h"
+#include <atomic>
+
+class OscRemoteTests : public juce::UnitTest
+{
+public:
+    OscRemoteTests() : juce::UnitTest ("OscRemote", "RosettaPrompter") {}
+
+    void runTest() override
+    {
+        // Broadcast bundles come back through the packet sink instead of a socket.
+        std::atomic<int> broadcastLine { 0 };
+        std::atomic<int> broadcastNumLines { 0 };
+
+        RosettaPrompterAudioProcessor processor;
+        processor.setLyricsText ("one\ntwo\nthree\nfour\nfive");
+
+        processor.getOscRemote().setPacketSink ([&] (const juce::OSCBundle& bundle)
+        {
+            for (auto& element : bundle)
+            {
+                if (element.isMessage() && element.getMessage().getAddressPattern().toString() == "/rosetta/line")
+                {
+                    broadcastLine.store (element.getMessage()[0].getInt32());
+                    broadcastNumLines.store (element.getMessage()[1].getInt32());
+                }
+            }
+
+            return true;
+        });
+
+        processor.setOscEnabled (true);
+        expect (processor.isOscEnabled());
+
+        const auto send = [&processor] (const juce::OSCMessage& message)
+        {
+            processor.getOscRemote().handleMessage (message);
+            processor.updateRemoteControl();
+        };
+
+        beginTest ("Cue commands move the active line without an editor");
+        {
+            send (juce::OSCMessage ("/rosetta/jump", 3));
+            expectEquals (processor.getRemoteCueLine(), 2);
+            expect (waitFor (broadcastLine, 3));
+            expectEquals (broadcastNumLines.load(), 5);
+
+            send (juce::OSCMessage ("/rosetta/next"));
+            expectEquals (processor.getRemoteCueLine(), 3);
+            expect (waitFor (broadcastLine, 4));
+
+            send (juce::OSCMessage ("/rosetta/previous"));
+            send (juce::OSCMessage ("/rosetta/previous"));
+            expectEquals (processor.getRemoteCueLine(), 1);
+            expect (waitFor (broadcastLine, 2));
+
+            send (juce::OSCMessage ("/rosetta/jump", 99.0f));
+            expectEquals (processor.getRemoteCueLine(), 4);
+        }
+
+        beginTest ("Calibration and weight commands reach the processor");
+        {
+            send (juce::OSCMessage ("/rosetta/start", 8.0f));
+            send (juce::OSCMessage ("/rosetta/end", 72));
+            expectEquals (processor.getParameterValue (RosettaPrompterAudioProcessor::ParamIDs::startBar), 8.0f);
+            expectEquals (processor.getParameterValue (RosettaPrompterAudioProcessor::ParamIDs::endBar), 72.0f);
+
+            send (juce::OSCMessage ("/rosetta/weight", 2, 3.0f));
+            expect (processor.getLineWeightOverrides() == std::map<int, double> { { 1, 3.0 } });
+
+            send (juce::OSCMessage ("/rosetta/weight", 2, 0.0f));
+            expect (processor.getLineWeightOverrides().empty());
+        }
+
+        beginTest ("A loaded script replaces the lyrics");
+        {
+            juce::TemporaryFile script (".txt");
+            expect (script.getFile().replaceWithText ("a\nb\nc"));
+
+            const int revision = processor.getLyricsRevision();
+            send (juce::OSCMessage ("/rosetta/load", script.getFile().getFullPathName()));
+
+            expectEquals (processor.getLyricsText(), juce::String ("a\nb\nc"));
+            expectEquals (processor.getLyricsFile(), script.getFile());
+            expectGreaterThan (processor.getLyricsRevision(), revision);
+            expect (waitFor (broadcastNumLines, 3));
+            expect (waitFor (broadcastLine, 3));
+        }
+
+        processor.setOscEnabled (false);
+
+        beginTest ("The remote stays off when its port is taken");
+        {
+            juce::DatagramSocket blocker;
+            expect (blocker.bindToPort (0));
+
+            RosettaPrompterAudioProcessor other;
+            auto state = other.apvts.copyState();
+            state.setProperty ("oscListenPort", blocker.getBoundPort(), nullptr);
+            state.setProperty ("oscEnabled", true, nullptr);
+
+            juce::MemoryBlock data;
+            juce::AudioProcessor::copyXmlToBinary (*state.createXml(), data);
+            other.setStateInformation (data.getData(), (int) data.getSize());
+
+            expect (! other.isOscEnabled());
+            expect (! other.getOscRemote().isRunning());
+        }
+    }
+
+private:
+    static bool waitFor (const std::atomic<int>& value, int expected)
+    {
+        for (int i = 0; i < 200 && value.load() != expected; ++i)
+            juce::Thread::sleep (5);
+
+        return value.load() == expected;
+    }
+};
+
+static OscRemoteTests oscRemoteTests;
@@ -0,0 +1,54 @@
+#include "TeleprompterComponent.h"
+
+class TeleprompterComponentTests : public juce::UnitTest
+{
+public:
+    TeleprompterComponentTests() : juce::UnitTest ("TeleprompterComponent", "RosettaPrompter") {}
+
+    void runTest() override
+    {
+        for (const bool editing : { false, true })
+        {
+            beginTest (editing ? "Hot reload diffs reproduce the file's text while editing"
+                               : "Hot reload diffs reproduce the file's text");
+
+            TeleprompterComponent prompter;
+            prompter.setText ("one\ntwo\nthree\nfour");
+
+            if (editing)
+                prompter.beginEditing (0);
+
+            const auto reload = [this, &prompter] (const juce::String& fileText)
+            {
+                const auto diff = LineDiff::compute (juce::StringArray::fromLines (prompter.getText()),
+                                                     juce::StringArray::fromLines (fileText));
+
+                expect (prompter.applyLineDiff (0, diff, prompter.getColumnRevision (0)));
+                expectEquals (prompter.getText(), fileText);
+                expectEquals (prompter.getNumLines(), juce::StringArray::fromLines (fileText).size());
+            };
+
+            reload ("one\n2\nthree\nfour");
+            reload ("one\n2\nnew a\nnew b\nthree\nfour");
+            reload ("one\nthree\nfour");
+            reload ("one\nthree\nfour, reworded");
+            reload ("one\nthree");
+            reload ("zero\none\nthree");
+        }
+
+        beginTest ("A diff against an outdated revision is rejected");
+        {
+            TeleprompterComponent prompter;
+            prompter.setText ("one\ntwo");
+
+            const int revision = prompter.getColumnRevision (0);
+            prompter.setText ("one\ntwo\nthree");
+
+            const auto diff = LineDiff::compute (juce::StringArray { "one", "two" }, juce::StringArray { "one" });
+            expect (! prompter.applyLineDiff (0, diff, revision));
+            expectEquals (prompter.getText(), juce::String ("one\ntwo\nthree"));
+        }
+    }
+};
+
+static TeleprompterComponentTests teleprompterComponentTests;
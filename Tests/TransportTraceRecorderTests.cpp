@@ -0,0 +1,110 @@
+#include "TransportTraceRecorder.h"
+
+class TransportTraceRecorderTests : public juce::UnitTest
+{
+public:
+    TransportTraceRecorderTests() : juce::UnitTest ("TransportTraceRecorder", "RosettaPrompter") {}
+
+    void runTest() override
+    {
+        using Record = TransportTraceRecorder::Record;
+
+        juce::TemporaryFile trace (TransportTraceRecorder::fileExtension);
+        std::vector<Record> written;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            Record record;
+            record.wallTimeNs = 1.0e6 * i;
+            record.hostTimeNs = 2.0e6 * i + 0.5;
+            record.sampleRate = 48000.0;
+            record.ppq = 0.25 * i;
+            record.bpm = 90.0 + i;
+            record.loopStartPpq = 4.0;
+            record.loopEndPpq = 20.0;
+            record.numSamples = 64 + i;
+            record.numerator = 3;
+            record.flags = Record::hasPpq | (i % 2 == 0 ? Record::playing : 0) | Record::hasHostTime;
+            written.push_back (record);
+        }
+
+        beginTest ("Recorded blocks read back unchanged");
+        {
+            TransportTraceRecorder recorder;
+            expect (recorder.start (trace.getFile()));
+
+            for (auto& record : written)
+                recorder.push (record);
+
+            recorder.stop();
+            expectEquals (recorder.getNumDroppedRecords(), 0);
+
+            std::vector<Record> read;
+            expect (TransportTraceRecorder::readFile (trace.getFile(), read));
+            expectRecords (read, written);
+        }
+
+        beginTest ("A truncated last record is dropped");
+        {
+            {
+                juce::FileOutputStream out (trace.getFile());
+                expect (out.openedOk());
+
+                const char partial[10] = {};
+                out.write (partial, sizeof (partial));
+            }
+
+            std::vector<Record> read;
+            expect (TransportTraceRecorder::readFile (trace.getFile(), read));
+            expectRecords (read, written);
+        }
+
+        beginTest ("A restarted recording starts an empty trace");
+        {
+            TransportTraceRecorder recorder;
+            expect (recorder.start (trace.getFile()));
+            recorder.push (written.front());
+            recorder.stop();
+
+            expect (recorder.start (trace.getFile()));
+            recorder.push (written.back());
+            recorder.stop();
+
+            std::vector<Record> read;
+            expect (TransportTraceRecorder::readFile (trace.getFile(), read));
+            expectRecords (read, { written.back() });
+        }
+
+        beginTest ("Files without the trace header are rejected");
+        {
+            juce::TemporaryFile other (".txt");
+            expect (other.getFile().replaceWithText ("not a trace"));
+
+            std::vector<Record> read;
+            expect (! TransportTraceRecorder::readFile (other.getFile(), read));
+        }
+    }
+
+private:
+    void expectRecords (const std::vector<TransportTraceRecorder::Record>& actual,
+                        const std::vector<TransportTraceRecorder::Record>& expected)
+    {
+        expectEquals ((int) actual.size(), (int) expected.size());
+
+        for (size_t i = 0; i < juce::jmin (actual.size(), expected.size()); ++i)
+        {
+            expectEquals (actual[i].wallTimeNs, expected[i].wallTimeNs);
+            expectEquals (actual[i].hostTimeNs, expected[i].hostTimeNs);
+            expectEquals (actual[i].sampleRate, expected[i].sampleRate);
+            expectEquals (actual[i].ppq, expected[i].ppq);
+            expectEquals (actual[i].bpm, expected[i].bpm);
+            expectEquals (actual[i].loopStartPpq, expected[i].loopStartPpq);
+            expectEquals (actual[i].loopEndPpq, expected[i].loopEndPpq);
+            expectEquals (actual[i].numSamples, expected[i].numSamples);
+            expectEquals (actual[i].numerator, expected[i].numerator);
+            expectEquals (actual[i].flags, expected[i].flags);
+        }
+    }
+};
+
+static TransportTraceRecorderTests transportTraceRecorderTests;
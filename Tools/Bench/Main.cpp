@@ -0,0 +1,166 @@
+#include "PluginProcessor.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    class Stopwatch
+    {
+    public:
+        double getElapsedMs() const
+        {
+            return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1000.0;
+        }
+
+    private:
+        juce::int64 start = juce::Time::getHighResolutionTicks();
+    };
+
+    struct Stats
+    {
+        juce::String name;
+        std::vector<double> samples;
+
+        void print() const
+        {
+            if (samples.empty())
+                return;
+
+            auto sorted = samples;
+            std::sort (sorted.begin(), sorted.end());
+
+            double total = 0.0;
+            for (auto sample : sorted)
+                total += sample;
+
+            std::cout << name.paddedRight (' ', 20)
+                      << " mean " << juce::String (total / (double) sorted.size(), 3).paddedLeft (' ', 9) << " ms"
+                      << "  median " << juce::String (sorted[sorted.size() / 2], 3).paddedLeft (' ', 9) << " ms"
+                      << "  max " << juce::String (sorted.back(), 3).paddedLeft (' ', 9) << " ms"
+                      << "  total " << juce::String (total, 1).paddedLeft (' ', 9) << " ms\n";
+        }
+    };
+
+    juce::String makeLyrics (int numLines)
+    {
+        juce::StringArray lines;
+        for (int i = 0; i < numLines; ++i)
+            lines.add ("Line " + juce::String (i + 1) + " of the benchmark lyrics, sung at a steady pace");
+
+        return lines.joinIntoString ("\n");
+    }
+
+    int runStartupBenchmark (int numInstances, int numLyricsLines, bool openEditors)
+    {
+        juce::MemoryBlock state;
+        {
+            RosettaPrompterAudioProcessor reference;
+            reference.setLyricsText (makeLyrics (numLyricsLines));
+            reference.getStateInformation (state);
+        }
+
+        Stats construction { "construct" };
+        Stats restore { "restore state" };
+        Stats editorOpen { "open editor" };
+
+        std::vector<std::unique_ptr<RosettaPrompterAudioProcessor>> instances;
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            Stopwatch constructTimer;
+            instances.push_back (std::make_unique<RosettaPrompterAudioProcessor>());
+            construction.samples.push_back (constructTimer.getElapsedMs());
+
+            auto& processor = *instances.back();
+
+            Stopwatch restoreTimer;
+            processor.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+            restore.samples.push_back (restoreTimer.getElapsedMs());
+
+            if (openEditors)
+            {
+                Stopwatch editorTimer;
+                std::unique_ptr<juce::AudioProcessorEditor> editor (processor.createEditorIfNeeded());
+                editorOpen.samples.push_back (editorTimer.getElapsedMs());
+            }
+        }
+
+        std::cout << "Startup: " << numInstances << " instances, " << numLyricsLines << " lyric lines, "
+                  << (int) state.getSize() << " byte state\n";
+
+        construction.print();
+        restore.print();
+        editorOpen.print();
+        return 0;
+    }
+
+    int runMeterBenchmark (double sampleRate, int blockSize, double seconds)
+    {
+        constexpr int numChannels = 2;
+
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        juce::Random random (1234);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                buffer.setSample (channel, i, random.nextFloat() * 0.5f - 0.25f);
+
+        InputMeter meter;
+        meter.prepare (sampleRate, blockSize, numChannels);
+
+        const int numBlocks = juce::jmax (1, juce::roundToInt (seconds * sampleRate / blockSize));
+        Stats blocks { "meter block" };
+        blocks.samples.reserve ((size_t) numBlocks);
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            Stopwatch timer;
+            meter.process (buffer, numChannels);
+            blocks.samples.push_back (timer.getElapsedMs());
+        }
+
+        double totalMs = 0.0;
+        for (auto sample : blocks.samples)
+            totalMs += sample;
+
+        const double blockDurationMs = 1000.0 * blockSize / sampleRate;
+
+        std::cout << "Input meter: " << sampleRate << " Hz, " << blockSize << " samples, stereo, "
+                  << seconds << " s of audio\n";
+        blocks.print();
+        std::cout << juce::String ("cpu load").paddedRight (' ', 20) << " "
+                  << juce::String (100.0 * totalMs / (numBlocks * blockDurationMs), 4) << " % of real time, "
+                  << juce::String (1.0e6 * totalMs / ((double) numBlocks * blockSize), 2) << " ns per sample frame\n";
+        return 0;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << "Usage: RosettaPrompterBench [--instances <n>] [--lyrics-lines <n>] [--no-editor]\n"
+                     "       RosettaPrompterBench --meter [--sample-rate <hz>] [--block-size <n>] [--seconds <s>]\n";
+        return 0;
+    }
+
+    if (args.containsOption ("--meter"))
+    {
+        const double sampleRate = args.containsOption ("--sample-rate") ? args.getValueForOption ("--sample-rate").getDoubleValue() : 192000.0;
+        const int blockSize = args.containsOption ("--block-size") ? args.getValueForOption ("--block-size").getIntValue() : 512;
+        const double seconds = args.containsOption ("--seconds") ? args.getValueForOption ("--seconds").getDoubleValue() : 60.0;
+
+        return runMeterBenchmark (juce::jmax (8000.0, sampleRate), juce::jmax (16, blockSize), juce::jmax (1.0, seconds));
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const int numInstances = args.containsOption ("--instances") ? args.getValueForOption ("--instances").getIntValue() : 80;
+    const int numLyricsLines = args.containsOption ("--lyrics-lines") ? args.getValueForOption ("--lyrics-lines").getIntValue() : 400;
+
+    return runStartupBenchmark (juce::jmax (1, numInstances), juce::jmax (1, numLyricsLines),
+                                ! args.containsOption ("--no-editor"));
+}
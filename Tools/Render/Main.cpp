@@ -0,0 +1,331 @@
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "PrompterFrameRenderer.h"
+#include "PrompterTimeline.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct RenderSettings
+    {
+        juce::File lyricsFile;
+        juce::File timingFile;
+        juce::File output;
+        bool rawOutput = false;
+        int width = 1920;
+        int height = 1080;
+        double fps = 60.0;
+        double bpm = 120.0;
+        int numerator = 4;
+        double offsetBar = 0.0;
+        double startBar = 0.0;
+        double endBar = 64.0;
+        double durationSeconds = 0.0;
+        float fontSize = 48.0f;
+        bool darkTheme = true;
+        int numThreads = 0;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: RosettaPrompterRender --lyrics <file.txt> --output <dir|file.raw> [options]\n"
+                     "\n"
+                     "  --format png|raw      numbered PNG sequence (default) or a raw BGRA frame stream\n"
+                     "  --width <px>          frame width (default 1920)\n"
+                     "  --height <px>         frame height (default 1080)\n"
+                     "  --fps <rate>          frames per second (default 60)\n"
+                     "  --bpm <tempo>         tempo in beats per minute (default 120)\n"
+                     "  --numerator <beats>   beats per bar (default 4)\n"
+                     "  --offset-bar <bar>    bar position at time zero (default 0)\n"
+                     "  --start-bar <bar>     calibration start bar (default 0)\n"
+                     "  --end-bar <bar>       calibration end bar (default 64)\n"
+                     "  --timing <file>       timing map, one line start bar per lyric line\n"
+                     "  --duration <seconds>  render length (default: until end bar + 1 bar)\n"
+                     "  --font-size <pt>      font size (default 48)\n"
+                     "  --theme dark|light    colour theme (default dark)\n"
+                     "  --threads <n>         worker threads (default: all cores)\n";
+    }
+
+    juce::String getOption (const juce::ArgumentList& args, juce::StringRef option, const juce::String& fallback = {})
+    {
+        return args.containsOption (option) ? args.getValueForOption (option) : fallback;
+    }
+
+    std::vector<double> loadTimingMap (const juce::File& file)
+    {
+        std::vector<double> bars;
+
+        for (auto& line : juce::StringArray::fromLines (file.loadFileAsString()))
+            if (line.trim().isNotEmpty())
+                bars.push_back (line.trim().getDoubleValue());
+
+        return bars;
+    }
+
+    juce::Image renderFrame (const PrompterFrameRenderer& renderer, const PrompterTimeline& timeline,
+                             const RenderSettings& settings, int frameIndex)
+    {
+        const double seconds = frameIndex / settings.fps;
+        const double bar = settings.offsetBar + seconds * settings.bpm / (60.0 * settings.numerator);
+
+        juce::Image image (juce::Image::ARGB, settings.width, settings.height, false, juce::SoftwareImageType());
+        juce::Graphics g (image);
+        renderer.renderFrame (g, settings.width, settings.height, timeline.getPositionAtBar (bar));
+
+        return image;
+    }
+
+    bool writePng (const juce::Image& image, const juce::File& file)
+    {
+        juce::FileOutputStream stream (file);
+        if (! stream.openedOk() || ! stream.setPosition (0) || ! stream.truncate().wasOk())
+            return false;
+
+        juce::PNGImageFormat png;
+        return png.writeImageToStream (image, stream);
+    }
+
+    bool writeRaw (const juce::Image& image, juce::OutputStream& stream)
+    {
+        const juce::Image::BitmapData pixels (image, juce::Image::BitmapData::readOnly);
+        const auto rowBytes = static_cast<size_t> (image.getWidth() * pixels.pixelStride);
+
+        for (int y = 0; y < image.getHeight(); ++y)
+            if (! stream.write (pixels.getLinePointer (y), rowBytes))
+                return false;
+
+        return true;
+    }
+
+    // Passes frames rendered out of order to the one thread writing the raw
+    // stream, in frame order. Workers stay at most maxAhead frames ahead of
+    // the writer, which bounds the memory held in rendered images.
+    class OrderedFrameQueue
+    {
+    public:
+        explicit OrderedFrameQueue (int maxAheadToUse) : maxAhead (maxAheadToUse) {}
+
+        // Blocks until the frame is close enough to the writer to render.
+        // Returns false once the queue is cancelled.
+        bool waitForTurn (int frame)
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            changed.wait (lock, [&] { return cancelled || frame < nextFrame + maxAhead; });
+            return ! cancelled;
+        }
+
+        void push (int frame, juce::Image image)
+        {
+            {
+                const std::lock_guard<std::mutex> lock (mutex);
+                frames[frame] = std::move (image);
+            }
+
+            changed.notify_all();
+        }
+
+        // Blocks until the next frame in order arrives. Returns an invalid
+        // image once the queue is cancelled.
+        juce::Image pop()
+        {
+            juce::Image image;
+
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                changed.wait (lock, [&] { return cancelled || frames.count (nextFrame) > 0; });
+
+                if (cancelled)
+                    return {};
+
+                const auto found = frames.find (nextFrame++);
+                image = std::move (found->second);
+                frames.erase (found);
+            }
+
+            changed.notify_all();
+            return image;
+        }
+
+        void cancel()
+        {
+            {
+                const std::lock_guard<std::mutex> lock (mutex);
+                cancelled = true;
+            }
+
+            changed.notify_all();
+        }
+
+    private:
+        const int maxAhead;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::map<int, juce::Image> frames;
+        int nextFrame = 0;
+        bool cancelled = false;
+    };
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h") || ! args.containsOption ("--lyrics") || ! args.containsOption ("--output"))
+    {
+        printUsage();
+        return args.containsOption ("--help|-h") ? 0 : 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderSettings settings;
+    settings.lyricsFile = args.getFileForOption ("--lyrics");
+    settings.output = args.getFileForOption ("--output");
+    settings.rawOutput = getOption (args, "--format", "png") == "raw";
+    settings.width = juce::jmax (16, getOption (args, "--width", "1920").getIntValue());
+    settings.height = juce::jmax (16, getOption (args, "--height", "1080").getIntValue());
+    settings.fps = juce::jmax (1.0, getOption (args, "--fps", "60").getDoubleValue());
+    settings.bpm = juce::jmax (1.0, getOption (args, "--bpm", "120").getDoubleValue());
+    settings.numerator = juce::jmax (1, getOption (args, "--numerator", "4").getIntValue());
+    settings.offsetBar = getOption (args, "--offset-bar", "0").getDoubleValue();
+    settings.startBar = getOption (args, "--start-bar", "0").getDoubleValue();
+    settings.endBar = getOption (args, "--end-bar", "64").getDoubleValue();
+    settings.fontSize = juce::jlimit (6.0f, 400.0f, getOption (args, "--font-size", "48").getFloatValue());
+    settings.darkTheme = getOption (args, "--theme", "dark") != "light";
+    settings.numThreads = getOption (args, "--threads", "0").getIntValue();
+
+    if (args.containsOption ("--timing"))
+        settings.timingFile = args.getFileForOption ("--timing");
+
+    for (auto& file : { settings.lyricsFile, settings.timingFile })
+    {
+        if (file != juce::File() && ! file.existsAsFile())
+        {
+            std::cerr << "File not found: " << file.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+
+    if (settings.numThreads <= 0)
+        settings.numThreads = juce::SystemStats::getNumCpus();
+
+    const auto lines = juce::StringArray::fromLines (settings.lyricsFile.loadFileAsString());
+
+    PrompterTimeline timeline;
+    timeline.setNumLines (lines.size());
+    timeline.setCalibration (settings.startBar, settings.endBar);
+
+    double lastBar = settings.endBar;
+
+    if (settings.timingFile.existsAsFile())
+    {
+        auto startBars = loadTimingMap (settings.timingFile);
+        if (! startBars.empty())
+            lastBar = juce::jmax (lastBar, *std::max_element (startBars.begin(), startBars.end()));
+
+        timeline.setLineStartBars (std::move (startBars));
+    }
+
+    const double secondsPerBar = 60.0 * settings.numerator / settings.bpm;
+    settings.durationSeconds = args.containsOption ("--duration")
+        ? args.getValueForOption ("--duration").getDoubleValue()
+        : (lastBar + 1.0 - settings.offsetBar) * secondsPerBar;
+
+    const int numFrames = juce::jmax (1, juce::roundToInt (settings.durationSeconds * settings.fps));
+
+    // The raw stream is emptied and opened once, before any worker starts, and
+    // only this thread writes to it.
+    std::unique_ptr<juce::FileOutputStream> rawStream;
+
+    if (settings.rawOutput)
+    {
+        settings.output.deleteFile();
+        settings.output.getParentDirectory().createDirectory();
+        rawStream = std::make_unique<juce::FileOutputStream> (settings.output);
+
+        if (! rawStream->openedOk())
+        {
+            std::cerr << "Cannot open " << settings.output.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+    else if (! settings.output.createDirectory())
+    {
+        std::cerr << "Cannot create output folder " << settings.output.getFullPathName() << "\n";
+        return 1;
+    }
+
+    std::atomic<int> nextFrame { 0 };
+    std::atomic<bool> failed { false };
+    OrderedFrameQueue rawFrames (settings.numThreads * 2);
+    std::vector<std::thread> workers;
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    for (int t = 0; t < settings.numThreads; ++t)
+    {
+        workers.emplace_back ([&]
+        {
+            // Each worker has its own renderer, and with it its own Font and
+            // layout cache, so no glyph state is shared between threads.
+            const PrompterFrameRenderer renderer (lines, settings.fontSize, settings.darkTheme);
+
+            for (int frame = nextFrame++; frame < numFrames && ! failed.load(); frame = nextFrame++)
+            {
+                if (settings.rawOutput)
+                {
+                    if (! rawFrames.waitForTurn (frame))
+                        break;
+
+                    rawFrames.push (frame, renderFrame (renderer, timeline, settings, frame));
+                }
+                else if (! writePng (renderFrame (renderer, timeline, settings, frame),
+                                     settings.output.getChildFile ("frame_" + juce::String (frame).paddedLeft ('0', 6) + ".png")))
+                {
+                    failed.store (true);
+                }
+            }
+        });
+    }
+
+    if (rawStream != nullptr)
+    {
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            const auto image = rawFrames.pop();
+
+            if (! image.isValid() || ! writeRaw (image, *rawStream))
+            {
+                failed.store (true);
+                rawFrames.cancel();
+                break;
+            }
+        }
+
+        rawStream->flush();
+        if (rawStream->getStatus().failed())
+            failed.store (true);
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    if (failed.load())
+    {
+        std::cerr << "Failed to write frames to " << settings.output.getFullPathName() << "\n";
+        return 1;
+    }
+
+    const auto elapsed = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    std::cout << "Rendered " << numFrames << " frames (" << settings.width << "x" << settings.height
+              << " @ " << settings.fps << " fps) in " << elapsed << " s on "
+              << settings.numThreads << " threads\n";
+
+    return 0;
+}
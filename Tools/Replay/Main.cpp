@@ -0,0 +1,466 @@
+#include "PluginProcessor.h"
+#include "PrompterFrameRenderer.h"
+#include "PrompterTimeline.h"
+#include "TransportTraceRecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace
+{
+    using Record = TransportTraceRecorder::Record;
+
+    struct ReplaySettings
+    {
+        juce::File traceFile;
+        juce::File lyricsFile;
+        juce::File timingFile;
+        juce::File csvFile;
+        int numLines = 64;
+        float startBar = 0.0f;
+        float endBar = 64.0f;
+        int timingMode = 0;
+        int viewHeight = 400;
+        float fontSize = 24.0f;
+        double maxErrorMs = -1.0;
+        bool quiet = false;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: RosettaPrompterReplay --trace <file.rptr> [options]\n"
+                     "\n"
+                     "  --lyrics <file.txt>   lyrics to replay against (default: --lines placeholder lines)\n"
+                     "  --lines <n>           number of placeholder lines (default 64)\n"
+                     "  --start-bar <bar>     calibration start bar (default 0)\n"
+                     "  --end-bar <bar>       calibration end bar (default 64)\n"
+                     "  --mode linear|weighted|tapped  line timing mode (default linear, tapped with --timing)\n"
+                     "  --timing <file>       tapped timing map, one line start bar per lyric line\n"
+                     "  --view-height <px>    prompter viewport height (default 400)\n"
+                     "  --font-size <pt>      font size (default 24)\n"
+                     "  --csv <file>          write the scroll trajectory, one row per 60 Hz frame\n"
+                     "  --max-error-ms <ms>   exit with status 1 if any line change lags by more\n"
+                     "  --quiet               print the summary only\n";
+    }
+
+    juce::String getOption (const juce::ArgumentList& args, juce::StringRef option, const juce::String& fallback = {})
+    {
+        return args.containsOption (option) ? args.getValueForOption (option) : fallback;
+    }
+
+    std::vector<double> loadTimingMap (const juce::File& file)
+    {
+        std::vector<double> bars;
+
+        for (auto& line : juce::StringArray::fromLines (file.loadFileAsString()))
+            if (line.trim().isNotEmpty())
+                bars.push_back (line.trim().getDoubleValue());
+
+        return bars;
+    }
+
+    class ReplayPlayHead : public juce::AudioPlayHead
+    {
+    public:
+        void setRecord (const Record& newRecord)
+        {
+            record = newRecord;
+        }
+
+        juce::Optional<PositionInfo> getPosition() const override
+        {
+            PositionInfo info;
+            info.setIsPlaying (record.hasFlag (Record::playing));
+            info.setIsLooping (record.hasFlag (Record::looping));
+            info.setBpm (record.bpm);
+            info.setTimeSignature (TimeSignature { record.numerator, 4 });
+
+            if (record.hasFlag (Record::looping))
+                info.setLoopPoints (LoopPoints { record.loopStartPpq, record.loopEndPpq });
+
+            if (record.hasFlag (Record::hasPpq))
+                info.setPpqPosition (record.ppq);
+
+            if (record.hasFlag (Record::hasHostTime))
+                info.setHostTimeNs (static_cast<juce::uint64> (record.hostTimeNs));
+
+            return info;
+        }
+
+    private:
+        Record record;
+    };
+
+    struct Transition
+    {
+        double timeMs = 0.0;
+        double bar = 0.0;
+        int fromLine = 0;
+        int toLine = 0;
+        double errorMs = 0.0;
+        bool hasError = false;
+    };
+
+    struct Summary
+    {
+        std::vector<double> errorsMs;
+        int backwardScrolls = 0;
+        double maxScrollStep = 0.0;
+        double maxCallbackGapMs = 0.0;
+        double callbackJitterMs = 0.0;
+        int minBlockSize = std::numeric_limits<int>::max();
+        int maxBlockSize = 0;
+    };
+
+    // Replays the editor's behaviour against a recorded trace: the processor runs
+    // each recorded block, the 30 Hz editor tick asks the processor for the active
+    // line exactly as the editor does, and the 60 Hz view tick eases the scroll
+    // towards it.
+    class TraceReplay
+    {
+    public:
+        TraceReplay (const ReplaySettings& settingsToUse, const juce::StringArray& linesToUse)
+            : settings (settingsToUse),
+              lines (linesToUse),
+              renderer (lines, settings.fontSize, true)
+        {
+            processor.setLyricsText (lines.joinIntoString ("\n"));
+            processor.setStartBar (settings.startBar);
+            processor.setEndBar (settings.endBar);
+            processor.setParameterValue (RosettaPrompterAudioProcessor::ParamIDs::timingMode, (float) settings.timingMode);
+            processor.setPlayHead (&playHead);
+
+            if (settings.timingFile.existsAsFile())
+                processor.setTimingMap (loadTimingMap (settings.timingFile));
+
+            timeline.setLines (lines);
+            timeline.setNumLines (lines.size());
+            processor.syncTimeline (timeline);
+        }
+
+        void run (const std::vector<Record>& records)
+        {
+            const double startNs = records.front().wallTimeNs;
+            nextEditorTickNs = startNs;
+            nextViewTickNs = startNs;
+
+            double preparedSampleRate = 0.0;
+            int maxBlockSize = 0;
+            for (auto& record : records)
+                maxBlockSize = juce::jmax (maxBlockSize, record.numSamples);
+
+            juce::AudioBuffer<float> buffer (2, juce::jmax (1, maxBlockSize));
+            juce::MidiBuffer midi;
+
+            const Record* previous = nullptr;
+
+            for (auto& record : records)
+            {
+                runUiTicksUntil (record.wallTimeNs, startNs);
+
+                if (! juce::approximatelyEqual (record.sampleRate, preparedSampleRate))
+                {
+                    processor.setRateAndBufferSizeDetails (record.sampleRate, maxBlockSize);
+                    processor.prepareToPlay (record.sampleRate, maxBlockSize);
+                    preparedSampleRate = record.sampleRate;
+                }
+
+                playHead.setRecord (record);
+                buffer.setSize (2, record.numSamples, false, false, true);
+                buffer.clear();
+                processor.processBlock (buffer, midi);
+
+                trackIdealTransitions (record);
+                trackCallbackTiming (record, previous);
+                previous = &record;
+            }
+
+            const auto& last = records.back();
+            runUiTicksUntil (last.wallTimeNs + 1.0e9 * last.numSamples / last.sampleRate, startNs);
+        }
+
+        void writeCsv (const juce::File& file) const
+        {
+            file.replaceWithText ("time_ms,bar,active_line,target_scroll,scroll\n" + csvRows.joinIntoString ("\n") + "\n");
+        }
+
+        const std::vector<Transition>& getTransitions() const { return transitions; }
+        const Summary& getSummary() const { return summary; }
+
+    private:
+        static constexpr double editorTickNs = 1.0e9 / 30.0;
+        static constexpr double viewTickNs = 1.0e9 / 60.0;
+
+        void runUiTicksUntil (double wallTimeNs, double startNs)
+        {
+            while (juce::jmin (nextEditorTickNs, nextViewTickNs) < wallTimeNs)
+            {
+                if (nextEditorTickNs <= nextViewTickNs)
+                {
+                    editorTick (nextEditorTickNs, startNs);
+                    nextEditorTickNs += editorTickNs;
+                }
+                else
+                {
+                    viewTick (nextViewTickNs, startNs);
+                    nextViewTickNs += viewTickNs;
+                }
+            }
+        }
+
+        void editorTick (double nowNs, double startNs)
+        {
+            const auto active = processor.followTransport (timeline);
+            if (! active.isValid)
+                return;
+
+            const double bar = processor.getLastBarPosition();
+            const int line = active.position.line;
+
+            if (line != activeLine)
+            {
+                Transition transition { (nowNs - startNs) * 1.0e-6, bar, activeLine, line };
+
+                const auto ideal = idealEntryTimes.find (line);
+                if (ideal != idealEntryTimes.end())
+                {
+                    transition.errorMs = (nowNs - ideal->second) * 1.0e-6;
+                    transition.hasError = true;
+                    summary.errorsMs.push_back (transition.errorMs);
+                }
+
+                transitions.push_back (transition);
+                activeLine = line;
+            }
+
+            targetScroll = renderer.getScrollForLine (activeLine, settings.viewHeight);
+            playing = processor.isTransportPlaying();
+
+            if (active.positionJumped)
+                scroll = std::round (targetScroll);
+        }
+
+        void viewTick (double nowNs, double startNs)
+        {
+            const double previousScroll = scroll;
+            scroll = std::round (PrompterFrameRenderer::getSmoothedScroll (scroll, targetScroll));
+
+            if (playing && scroll < previousScroll)
+                ++summary.backwardScrolls;
+
+            summary.maxScrollStep = juce::jmax (summary.maxScrollStep, std::abs (scroll - previousScroll));
+
+            if (settings.csvFile != juce::File())
+                csvRows.add (juce::String ((nowNs - startNs) * 1.0e-6, 3) + "," + juce::String (processor.getLastBarPosition(), 6)
+                             + "," + juce::String (activeLine) + "," + juce::String (targetScroll, 1) + "," + juce::String (scroll, 1));
+        }
+
+        int getIdealLine (double bar) const
+        {
+            return timeline.getPositionAtBar (bar).line;
+        }
+
+        // Works out when each line would have started with a zero-latency view:
+        // at the exact sample within a block, or at the block start after a jump.
+        void trackIdealTransitions (const Record& record)
+        {
+            if (! record.hasFlag (Record::hasPpq))
+                return;
+
+            const double numerator = static_cast<double> (juce::jmax (1, record.numerator));
+            const double barStart = record.ppq / numerator;
+            const double barsPerNs = record.hasFlag (Record::playing) ? record.bpm / (60.0 * numerator) * 1.0e-9 : 0.0;
+            const double barEnd = barStart + barsPerNs * 1.0e9 * record.numSamples / record.sampleRate;
+
+            double lo = barStart;
+            int line = getIdealLine (lo);
+
+            if (line != idealLine)
+                idealEntryTimes[line] = record.wallTimeNs;
+
+            while (barsPerNs > 0.0 && getIdealLine (barEnd) != line)
+            {
+                double hi = barEnd;
+                for (int i = 0; i < 48; ++i)
+                {
+                    const double mid = 0.5 * (lo + hi);
+
+                    if (getIdealLine (mid) == line)
+                        lo = mid;
+                    else
+                        hi = mid;
+                }
+
+                line = getIdealLine (hi);
+                idealEntryTimes[line] = record.wallTimeNs + (hi - barStart) / barsPerNs;
+                lo = hi;
+            }
+
+            idealLine = getIdealLine (barEnd);
+        }
+
+        void trackCallbackTiming (const Record& record, const Record* previous)
+        {
+            summary.minBlockSize = juce::jmin (summary.minBlockSize, record.numSamples);
+            summary.maxBlockSize = juce::jmax (summary.maxBlockSize, record.numSamples);
+
+            if (previous == nullptr || record.hasFlag (Record::nonRealtime))
+                return;
+
+            const double gapMs = (record.wallTimeNs - previous->wallTimeNs) * 1.0e-6;
+            const double expectedMs = 1000.0 * previous->numSamples / previous->sampleRate;
+
+            summary.maxCallbackGapMs = juce::jmax (summary.maxCallbackGapMs, gapMs);
+            summary.callbackJitterMs = juce::jmax (summary.callbackJitterMs, std::abs (gapMs - expectedMs));
+        }
+
+        const ReplaySettings& settings;
+        juce::StringArray lines;
+        ReplayPlayHead playHead;
+        RosettaPrompterAudioProcessor processor;
+        PrompterTimeline timeline;
+        PrompterFrameRenderer renderer;
+
+        double nextEditorTickNs = 0.0;
+        double nextViewTickNs = 0.0;
+        int activeLine = 0;
+        double targetScroll = 0.0;
+        double scroll = 0.0;
+        bool playing = false;
+
+        int idealLine = -1;
+        std::map<int, double> idealEntryTimes;
+
+        std::vector<Transition> transitions;
+        juce::StringArray csvRows;
+        Summary summary;
+    };
+
+    double getPercentile (std::vector<double> values, double percentile)
+    {
+        if (values.empty())
+            return 0.0;
+
+        std::sort (values.begin(), values.end());
+        const auto index = static_cast<size_t> (percentile * (double) (values.size() - 1));
+        return values[index];
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h") || ! args.containsOption ("--trace"))
+    {
+        printUsage();
+        return args.containsOption ("--help|-h") ? 0 : 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    ReplaySettings settings;
+    settings.traceFile = args.getFileForOption ("--trace");
+    settings.numLines = juce::jmax (1, getOption (args, "--lines", "64").getIntValue());
+    settings.startBar = getOption (args, "--start-bar", "0").getFloatValue();
+    settings.endBar = getOption (args, "--end-bar", "64").getFloatValue();
+    settings.viewHeight = juce::jmax (16, getOption (args, "--view-height", "400").getIntValue());
+    settings.fontSize = juce::jlimit (6.0f, 400.0f, getOption (args, "--font-size", "24").getFloatValue());
+    settings.maxErrorMs = getOption (args, "--max-error-ms", "-1").getDoubleValue();
+    settings.quiet = args.containsOption ("--quiet");
+
+    if (args.containsOption ("--lyrics"))
+        settings.lyricsFile = args.getFileForOption ("--lyrics");
+
+    if (args.containsOption ("--timing"))
+        settings.timingFile = args.getFileForOption ("--timing");
+
+    const auto mode = getOption (args, "--mode", settings.timingFile != juce::File() ? "tapped" : "linear");
+    settings.timingMode = juce::jmax (0, juce::StringArray { "linear", "weighted", "tapped" }.indexOf (mode));
+
+    if (args.containsOption ("--csv"))
+        settings.csvFile = args.getFileForOption ("--csv");
+
+    for (auto& file : { settings.traceFile, settings.lyricsFile, settings.timingFile })
+    {
+        if (file != juce::File() && ! file.existsAsFile())
+        {
+            std::cerr << "File not found: " << file.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<Record> records;
+    if (! TransportTraceRecorder::readFile (settings.traceFile, records))
+    {
+        std::cerr << "Not a transport trace: " << settings.traceFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    if (records.empty())
+    {
+        std::cerr << "The trace contains no blocks\n";
+        return 1;
+    }
+
+    juce::StringArray lines;
+    if (settings.lyricsFile.existsAsFile())
+    {
+        lines = juce::StringArray::fromLines (settings.lyricsFile.loadFileAsString());
+    }
+    else
+    {
+        for (int i = 0; i < settings.numLines; ++i)
+            lines.add ("Line " + juce::String (i + 1));
+    }
+
+    TraceReplay replay (settings, lines);
+    replay.run (records);
+
+    if (settings.csvFile != juce::File())
+        replay.writeCsv (settings.csvFile);
+
+    if (! settings.quiet)
+    {
+        for (auto& transition : replay.getTransitions())
+        {
+            std::cout << juce::String (transition.timeMs / 1000.0, 3).paddedLeft (' ', 10) << " s"
+                      << "  bar " << juce::String (transition.bar, 3).paddedLeft (' ', 9)
+                      << "  line " << juce::String (transition.fromLine + 1).paddedLeft (' ', 4)
+                      << " -> " << juce::String (transition.toLine + 1).paddedLeft (' ', 4);
+
+            if (transition.hasError)
+                std::cout << "  late " << juce::String (transition.errorMs, 1).paddedLeft (' ', 7) << " ms";
+
+            std::cout << "\n";
+        }
+    }
+
+    const auto& summary = replay.getSummary();
+    const auto& first = records.front();
+    const auto& last = records.back();
+    const double durationSeconds = (last.wallTimeNs - first.wallTimeNs) * 1.0e-9;
+    const double maxErrorMs = summary.errorsMs.empty() ? 0.0 : *std::max_element (summary.errorsMs.begin(), summary.errorsMs.end());
+
+    std::cout << "Trace: " << (int) records.size() << " blocks over " << juce::String (durationSeconds, 2) << " s at "
+              << first.sampleRate << " Hz, block sizes " << summary.minBlockSize << "-" << summary.maxBlockSize << "\n"
+              << "Callbacks: max gap " << juce::String (summary.maxCallbackGapMs, 2) << " ms, max jitter "
+              << juce::String (summary.callbackJitterMs, 2) << " ms\n"
+              << "Line changes: " << (int) replay.getTransitions().size() << ", lag median "
+              << juce::String (getPercentile (summary.errorsMs, 0.5), 1) << " ms, p95 "
+              << juce::String (getPercentile (summary.errorsMs, 0.95), 1) << " ms, max "
+              << juce::String (maxErrorMs, 1) << " ms\n"
+              << "Scroll: " << summary.backwardScrolls << " backward steps while playing, largest step "
+              << juce::String (summary.maxScrollStep, 0) << " px\n";
+
+    if (settings.maxErrorMs >= 0.0 && maxErrorMs > settings.maxErrorMs)
+    {
+        std::cerr << "Line change lag " << maxErrorMs << " ms exceeds " << settings.maxErrorMs << " ms\n";
+        return 1;
+    }
+
+    return 0;
+}
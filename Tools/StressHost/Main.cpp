@@ -0,0 +1,423 @@
+#include "PluginProcessor.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if JUCE_LINUX
+ #include <unistd.h>
+#elif JUCE_MAC
+ #include <mach/mach.h>
+#endif
+
+namespace
+{
+    struct StressSettings
+    {
+        juce::Array<int> instanceCounts { 1, 10, 50, 120, 250, 500 };
+        juce::Array<int> blockSizes { 32, 128, 512 };
+        int numThreads = 4;
+        double sampleRate = 48000.0;
+        double seconds = 2.0;
+        int stateIntervalMs = 20;
+        int lyricsLines = 400;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: RosettaPrompterStressHost [options]\n"
+                     "\n"
+                     "  --instances <n,n,...>    instance counts to run (default 1,10,50,120,250,500)\n"
+                     "  --block-sizes <n,n,...>  buffer sizes to run (default 32,128,512)\n"
+                     "  --threads <n>            audio worker threads (default 4)\n"
+                     "  --sample-rate <hz>       sample rate (default 48000)\n"
+                     "  --seconds <s>            audio to process per configuration (default 2)\n"
+                     "  --state-interval <ms>    pause between state save/restore calls (default 20)\n"
+                     "  --lyrics-lines <n>       lyrics size in each instance's state (default 400)\n"
+                     "\n"
+                     "Configure with -DROSETTA_TSAN=ON to run under ThreadSanitizer.\n";
+    }
+
+    juce::Array<int> parseList (const juce::String& text)
+    {
+        juce::Array<int> values;
+        for (auto& token : juce::StringArray::fromTokens (text, ",", {}))
+            if (token.getIntValue() > 0)
+                values.add (token.getIntValue());
+
+        return values;
+    }
+
+    juce::int64 getResidentBytes()
+    {
+       #if JUCE_LINUX
+        const auto fields = juce::StringArray::fromTokens (juce::File ("/proc/self/statm").loadFileAsString(), " ", {});
+        return fields.size() > 1 ? fields[1].getLargeIntValue() * (juce::int64) sysconf (_SC_PAGESIZE) : 0;
+       #elif JUCE_MAC
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info (mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS)
+            return 0;
+
+        return (juce::int64) info.resident_size;
+       #else
+        return 0;
+       #endif
+    }
+
+    double getTimeUs()
+    {
+        return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks()) * 1.0e6;
+    }
+
+    juce::String makeLyrics (int numLines)
+    {
+        juce::StringArray lines;
+        for (int i = 0; i < numLines; ++i)
+            lines.add ("Line " + juce::String (i + 1) + " of the stress test lyrics, sung at a steady pace");
+
+        return lines.joinIntoString ("\n");
+    }
+
+    // A transport playing at 120 bpm in 4/4, looping over 32 bars so the
+    // processor also sees loop wraps. Only moved between processing cycles.
+    class SyntheticPlayHead : public juce::AudioPlayHead
+    {
+    public:
+        void reset (double newSampleRate)
+        {
+            sampleRate = newSampleRate;
+            samplePosition = 0;
+        }
+
+        void advance (int numSamples)
+        {
+            samplePosition += numSamples;
+        }
+
+        juce::Optional<PositionInfo> getPosition() const override
+        {
+            const double beats = static_cast<double> (samplePosition) / sampleRate * bpm / 60.0;
+
+            PositionInfo info;
+            info.setIsPlaying (true);
+            info.setIsLooping (true);
+            info.setBpm (bpm);
+            info.setTimeSignature (TimeSignature { 4, 4 });
+            info.setLoopPoints (LoopPoints { 0.0, loopBeats });
+            info.setTimeInSamples (samplePosition);
+            info.setPpqPosition (std::fmod (beats, loopBeats));
+            return info;
+        }
+
+    private:
+        static constexpr double bpm = 120.0;
+        static constexpr double loopBeats = 128.0;
+
+        double sampleRate = 48000.0;
+        juce::int64 samplePosition = 0;
+    };
+
+    struct Percentiles
+    {
+        double mean = 0.0, p50 = 0.0, p99 = 0.0, p999 = 0.0, max = 0.0;
+
+        static Percentiles of (std::vector<double>& values)
+        {
+            Percentiles result;
+            if (values.empty())
+                return result;
+
+            std::sort (values.begin(), values.end());
+
+            double total = 0.0;
+            for (auto value : values)
+                total += value;
+
+            const auto at = [&values] (double p) { return values[static_cast<size_t> (p * (double) (values.size() - 1))]; };
+
+            result.mean = total / (double) values.size();
+            result.p50 = at (0.5);
+            result.p99 = at (0.99);
+            result.p999 = at (0.999);
+            result.max = values.back();
+            return result;
+        }
+    };
+
+    // Runs every instance once per cycle, spread over a pool of worker threads
+    // the way a host's audio thread pool would, and waits for all of them.
+    class CycleRunner
+    {
+    public:
+        CycleRunner (std::vector<std::unique_ptr<RosettaPrompterAudioProcessor>>& instancesToRun,
+                     std::vector<juce::AudioBuffer<float>>& buffersToUse, int numThreads)
+            : instances (instancesToRun),
+              buffers (buffersToUse),
+              blockTimes ((size_t) numThreads)
+        {
+            for (int t = 0; t < numThreads; ++t)
+                workers.emplace_back ([this, t] { workerLoop ((size_t) t); });
+        }
+
+        ~CycleRunner()
+        {
+            {
+                const std::lock_guard<std::mutex> lock (mutex);
+                shouldExit = true;
+            }
+
+            startCondition.notify_all();
+
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        void runCycle()
+        {
+            {
+                const std::lock_guard<std::mutex> lock (mutex);
+                nextInstance.store (0);
+                workersBusy = (int) workers.size();
+                ++generation;
+            }
+
+            startCondition.notify_all();
+
+            std::unique_lock<std::mutex> lock (mutex);
+            doneCondition.wait (lock, [this] { return workersBusy == 0; });
+        }
+
+        std::vector<double> takeBlockTimes()
+        {
+            std::vector<double> all;
+            for (auto& times : blockTimes)
+            {
+                all.insert (all.end(), times.begin(), times.end());
+                times.clear();
+            }
+
+            return all;
+        }
+
+    private:
+        void workerLoop (size_t threadIndex)
+        {
+            juce::MidiBuffer midi;
+            int seenGeneration = 0;
+
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock (mutex);
+                    startCondition.wait (lock, [&] { return shouldExit || generation != seenGeneration; });
+
+                    if (shouldExit)
+                        return;
+
+                    seenGeneration = generation;
+                }
+
+                for (int i = nextInstance++; i < (int) instances.size(); i = nextInstance++)
+                {
+                    const auto start = getTimeUs();
+                    instances[(size_t) i]->processBlock (buffers[(size_t) i], midi);
+                    blockTimes[threadIndex].push_back (getTimeUs() - start);
+                    midi.clear();
+                }
+
+                const std::lock_guard<std::mutex> lock (mutex);
+                if (--workersBusy == 0)
+                    doneCondition.notify_one();
+            }
+        }
+
+        std::vector<std::unique_ptr<RosettaPrompterAudioProcessor>>& instances;
+        std::vector<juce::AudioBuffer<float>>& buffers;
+        std::vector<std::vector<double>> blockTimes;
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable startCondition;
+        std::condition_variable doneCondition;
+        std::atomic<int> nextInstance { 0 };
+        int workersBusy = 0;
+        int generation = 0;
+        bool shouldExit = false;
+    };
+
+    void runConfiguration (const StressSettings& settings, int numInstances, int blockSize, const juce::MemoryBlock& state)
+    {
+        const auto memoryBefore = getResidentBytes();
+
+        SyntheticPlayHead playHead;
+        playHead.reset (settings.sampleRate);
+
+        std::vector<std::unique_ptr<RosettaPrompterAudioProcessor>> instances;
+        std::vector<juce::AudioBuffer<float>> buffers;
+        juce::Random random (numInstances * 1000 + blockSize);
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            auto processor = std::make_unique<RosettaPrompterAudioProcessor>();
+            processor->setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+            processor->setPlayHead (&playHead);
+            processor->setRateAndBufferSizeDetails (settings.sampleRate, blockSize);
+            processor->prepareToPlay (settings.sampleRate, blockSize);
+            instances.push_back (std::move (processor));
+        }
+
+        // Measured before the host-side buffers exist, so only the processors count.
+        const auto memoryPerInstance = numInstances > 0 ? (getResidentBytes() - memoryBefore) / numInstances : 0;
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            juce::AudioBuffer<float> buffer (2, blockSize);
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int n = 0; n < blockSize; ++n)
+                    buffer.setSample (channel, n, random.nextFloat() * 0.5f - 0.25f);
+
+            buffers.push_back (std::move (buffer));
+        }
+
+        std::atomic<bool> stopStateThread { false };
+        std::atomic<int> stateCalls { 0 };
+        std::atomic<int> stateMismatches { 0 };
+        std::vector<double> stateTimesUs;
+
+        // Hosts save and restore state from the message thread while audio runs.
+        std::thread stateThread ([&]
+        {
+            const auto expectedLyrics = instances.front()->getLyricsText();
+
+            for (size_t i = 0; ! stopStateThread.load(); i = (i + 1) % instances.size())
+            {
+                const auto start = getTimeUs();
+
+                juce::MemoryBlock saved;
+                instances[i]->getStateInformation (saved);
+                instances[i]->setStateInformation (saved.getData(), static_cast<int> (saved.getSize()));
+
+                stateTimesUs.push_back (getTimeUs() - start);
+                ++stateCalls;
+
+                if (instances[i]->getLyricsText() != expectedLyrics)
+                    ++stateMismatches;
+
+                std::this_thread::sleep_for (std::chrono::milliseconds (settings.stateIntervalMs));
+            }
+        });
+
+        const int numCycles = juce::jmax (1, juce::roundToInt (settings.seconds * settings.sampleRate / blockSize));
+        const double blockDurationUs = 1.0e6 * blockSize / settings.sampleRate;
+
+        std::vector<double> cycleTimes;
+        cycleTimes.reserve ((size_t) numCycles);
+        int overruns = 0;
+
+        {
+            CycleRunner runner (instances, buffers, settings.numThreads);
+
+            for (int cycle = 0; cycle < numCycles; ++cycle)
+            {
+                const auto start = getTimeUs();
+                runner.runCycle();
+                const auto elapsed = getTimeUs() - start;
+
+                cycleTimes.push_back (elapsed);
+                if (elapsed > blockDurationUs)
+                    ++overruns;
+
+                playHead.advance (blockSize);
+            }
+
+            stopStateThread.store (true);
+            stateThread.join();
+
+            auto blockTimes = runner.takeBlockTimes();
+            const auto block = Percentiles::of (blockTimes);
+            const auto cycles = Percentiles::of (cycleTimes);
+            const auto stateCallTimes = Percentiles::of (stateTimesUs);
+
+            std::cout << juce::String (numInstances).paddedLeft (' ', 5) << " x " << juce::String (blockSize).paddedLeft (' ', 4)
+                      << " | block us mean " << juce::String (block.mean, 2).paddedLeft (' ', 7)
+                      << " p99 " << juce::String (block.p99, 2).paddedLeft (' ', 7)
+                      << " p99.9 " << juce::String (block.p999, 2).paddedLeft (' ', 7)
+                      << " max " << juce::String (block.max, 1).paddedLeft (' ', 8)
+                      << " | load mean " << juce::String (100.0 * cycles.mean / blockDurationUs, 1).paddedLeft (' ', 6) << " %"
+                      << " p99 " << juce::String (100.0 * cycles.p99 / blockDurationUs, 1).paddedLeft (' ', 6) << " %"
+                      << " overruns " << juce::String (overruns).paddedLeft (' ', 5)
+                      << " | state " << stateCalls.load() << " calls, max " << juce::String (stateCallTimes.max / 1000.0, 2) << " ms"
+                      << (stateMismatches.load() > 0 ? ", " + juce::String (stateMismatches.load()) + " MISMATCHED" : juce::String())
+                      << " | " << (memoryPerInstance > 0 ? juce::File::descriptionOfSizeInBytes (memoryPerInstance) : juce::String ("n/a"))
+                      << " per instance\n";
+        }
+
+        for (auto& processor : instances)
+            processor->releaseResources();
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    StressSettings settings;
+
+    if (args.containsOption ("--instances"))
+        settings.instanceCounts = parseList (args.getValueForOption ("--instances"));
+
+    if (args.containsOption ("--block-sizes"))
+        settings.blockSizes = parseList (args.getValueForOption ("--block-sizes"));
+
+    if (args.containsOption ("--threads"))
+        settings.numThreads = juce::jmax (1, args.getValueForOption ("--threads").getIntValue());
+
+    if (args.containsOption ("--sample-rate"))
+        settings.sampleRate = juce::jmax (8000.0, args.getValueForOption ("--sample-rate").getDoubleValue());
+
+    if (args.containsOption ("--seconds"))
+        settings.seconds = juce::jmax (0.1, args.getValueForOption ("--seconds").getDoubleValue());
+
+    if (args.containsOption ("--state-interval"))
+        settings.stateIntervalMs = juce::jmax (0, args.getValueForOption ("--state-interval").getIntValue());
+
+    if (args.containsOption ("--lyrics-lines"))
+        settings.lyricsLines = juce::jmax (1, args.getValueForOption ("--lyrics-lines").getIntValue());
+
+    if (settings.instanceCounts.isEmpty() || settings.blockSizes.isEmpty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    juce::MemoryBlock state;
+    {
+        RosettaPrompterAudioProcessor reference;
+        reference.setLyricsText (makeLyrics (settings.lyricsLines));
+        reference.getStateInformation (state);
+    }
+
+    std::cout << "Stress host: " << settings.numThreads << " audio threads, " << settings.sampleRate << " Hz, "
+              << settings.seconds << " s of audio per run, state save/restore every "
+              << settings.stateIntervalMs << " ms\n";
+
+    for (auto numInstances : settings.instanceCounts)
+        for (auto blockSize : settings.blockSizes)
+            runConfiguration (settings, numInstances, blockSize, state);
+
+    return 0;
+}